@@ -741,7 +741,7 @@ static void V_PlotPixel(int32_t x, int32_t y, int32_t color)
     byte* dest = &fb[(ScreenYToOffset(y) << 1) + x];
 
     //The GBA must write in 16bits.
-    if((uint32_t)dest & 1)
+    if((uintptr_t)dest & 1)
     {
         //Odd addreses, we combine existing pixel with new one.
         uint16_t* dest16 = (uint16_t*)(dest - 1);
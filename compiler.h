@@ -25,6 +25,45 @@
 
 typedef uint16_t segment;
 
+#elif defined __linux__
+//64-bit Linux host build
+#include <ctype.h>
+#include <strings.h>
+#include <sys/mman.h>
+
+//The zone addresses its blocks with 32-bit paragraph numbers,
+//so it has to live in the lower 4 GB of the address space.
+static inline void* halloc(int32_t numb, size_t size)
+{
+	void* p = mmap(NULL, numb * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	if ((uintptr_t)p + numb * size > 0xffffffffUL)
+	{
+		munmap(p, numb * size);
+		return NULL;
+	}
+
+	return p;
+}
+
+typedef uint32_t segment;
+
+#define MK_FP(s,o) (void*)((((uintptr_t)(s))<<4)+(o))
+#define FP_SEG(p)  ((segment)(((uintptr_t)(p))>>4))
+#define FP_OFF(p)  0
+
+#define stricmp strcasecmp
+
+static inline char* strupr(char* s)
+{
+	for (char* c = s; *c; c++)
+		*c = toupper(*c);
+
+	return s;
+}
+
 #else
 //32-bit
 #define halloc(numb,size) malloc(numb*size)
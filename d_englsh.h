@@ -199,6 +199,9 @@
 #define STSTR_FPSON    "FPS Counter On"
 #define STSTR_FPSOFF   "FPS Counter Off"
 
+#define STSTR_ZONEON   "Zone Stats On"
+#define STSTR_ZONEOFF  "Zone Stats Off"
+
 /* f_finale.c */
 
 #define E1TEXT \
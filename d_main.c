@@ -43,8 +43,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 #include "doomdef.h"
+#include "compiler.h"
 #include "doomtype.h"
 #include "doomstat.h"
 #include "d_net.h"
@@ -455,6 +457,11 @@ static void D_DoomMainSetup(void)
     printf("R_Init: DOOM refresh daemon - [...................]\n");
     R_Init();
 
+    int16_t colcache = M_CheckParm("-colcache");
+    int16_t colways  = M_CheckParm("-colways");
+    R_InitColumnCache(colcache && colcache < myargc - 1 ? atoi(myargv[colcache + 1]) : 0,
+                      colways  && colways  < myargc - 1 ? atoi(myargv[colways  + 1]) : 0);
+
     printf("P_Init: Init Playloop state.\n");
     P_Init();
 
@@ -466,12 +473,20 @@ static void D_DoomMainSetup(void)
     printf("ST_Init: Init status bar.\n");
     ST_Init();
 
+    printf("R_InitLookupTables: Load lookup tables into memory.\n");
+    R_InitLookupTables();
+
     _g->highDetail = false;
 
     G_LoadSettings();
 
     _g->fps_show = false;
 
+    _g->nopvs = M_CheckParm("-nopvs");
+
+    if (M_CheckParm("-zonestats"))
+        _g->fileZoneStats = fopen("ZONESTAT.TXT", "a");
+
     I_InitGraphics();
 
     int16_t p = M_CheckParm("-timedemo");
@@ -675,6 +675,15 @@ static void G_DoCompleted (void)
         printf("FINISHED: E1M%ld\n", _g->gamemap);
     }
 
+    if (_g->fileZoneStats)
+    {
+        char title[16];
+        sprintf(title, "E1M%ld completed", _g->gamemap);
+        Z_DumpStats(_g->fileZoneStats, title);
+        R_DumpRenderStats(_g->fileZoneStats);
+        P_DumpThingPoolStats(_g->fileZoneStats);
+    }
+
     WI_Start (&_g->wminfo);
 }
 
@@ -1112,9 +1121,11 @@ void G_CheckDemoStatus (void)
         // killough -- added fps information and made it work for longer demos:
         uint32_t realtics = endtime-_g->starttime;
         uint32_t resultfps = TICRATE * 1000 * _g->gametic / realtics;
-        I_Error ("Timed %lu gametics in %lu realtics = %lu.%.3lu frames per second",
-                 (uint32_t) _g->gametic,realtics,
-                 resultfps / 1000, resultfps % 1000);
+        I_Exit ("Timed %lu gametics in %lu realtics = %lu.%.3lu frames per second\n"
+                "Lookup table cache: %lu hits, %lu misses",
+                (uint32_t) _g->gametic,realtics,
+                resultfps / 1000, resultfps % 1000,
+                _g->ltcachehits, _g->ltcachemisses);
     }
 
     Z_Free(_g->demobuffer);
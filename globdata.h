@@ -66,6 +66,7 @@ int32_t  pagetic;
 boolean singletics; // debug flag to cancel adaptiveness
 boolean advancedemo;
 boolean fps_show;
+boolean zonestats_show;
 
 uint32_t gamma;
 
@@ -82,6 +83,18 @@ FILE *fileTanToAngle;
 FILE *fileViewAngleToX;
 FILE *fileWAD;
 FILE *fileXToViewAngle;
+FILE *fileDistScale;
+FILE *fileYSlope;
+FILE *fileZoneStats;	// -zonestats, NULL when off
+
+// lookup tables in memory, NULL when they're read from disk
+const fixed_t *tableFineSine;
+const fixed_t *tableFineTan;
+const angle_t *tableTanToAngle;
+const int8_t  *tableViewAngleToX;
+const angle_t *tableXToViewAngle;
+const fixed_t *tableDistScale;
+const fixed_t *tableYSlope;
 
 
 //******************************************************************************
@@ -152,6 +165,7 @@ boolean         singledemo;           // quit after playing a demo from cmdline
 // widgets
 hu_textline_t  w_title;
 hu_stext_t     w_message;
+hu_textline_t  w_zonestats[2];
 int16_t        message_counter;
 
 boolean    message_on;
@@ -325,6 +339,14 @@ fixed_t lowfloor;
 sector_t *openfrontsector; // made global                    // phares
 sector_t *openbacksector;  // made global
 
+// Openings of the two sided lines, valid while their generation
+// equals the larger generation of their front and back sector.
+// P_CheckSector stamps a sector with the next heightgeneration
+// after every change of its floor or ceiling height.
+lineopening_t *lineopenings;
+uint32_t *sectorgenerations;
+uint32_t heightgeneration;
+
 divline_t trace;
 
 
@@ -395,6 +417,12 @@ const int16_t      *blockmap;              // was short -- killough
 // offsets in blockmap are from here
 const int16_t      *blockmaplump;          // was short -- killough
 
+// COMPACT_BLOCKMAP: the lines of block i are
+// blocklines[blockstart[i]] up to blocklines[blockstart[i+1]]
+int32_t            *blockstart;
+uint16_t           *blocklines;
+linebox_t          *lineboxes;             // bounding box of every line
+
 fixed_t   bmaporgx, bmaporgy;     // origin of block map
 
 mobj_t    **blocklinks;           // for thing chains
@@ -409,12 +437,27 @@ mobj_t    **blocklinks;           // for thing chains
 //
 
 const byte *rejectmatrix; // cph - const*
+boolean rejectvalid;      // the lump covers every pair of sectors
+
+// The renderer uses REJECT as a PVS,
+// unless -nopvs is given.
+boolean nopvs;
+byte *pvsnodes;           // bit per node, set if a subsector below it can be seen from pvssector
+int16_t pvssector;
+
+// Bumped whenever something changes that the player might see,
+// R_RenderPlayerView reuses the last frame until it does.
+uint32_t worldgeneration;
 
 // Maintain single and multi player starting spots.
 mapthing_t playerstarts[MAXPLAYERS];
 
-mobj_t*      thingPool;
+// Free mobjs are linked through snext.
+mobj_t*      thingPoolFree;
 uint32_t thingPoolSize;
+uint32_t thingPoolUsed;
+uint32_t thingPoolPeak;     // most mobjs in use since P_InitThingPool
+uint16_t thingPoolChunks;   // chunks added since P_InitThingPool
 
 
 //******************************************************************************
@@ -448,7 +491,7 @@ int32_t leveltime; // tics in game play for par
 
 // killough 8/29/98: we maintain several separate threads, each containing
 // a special class of thinkers, to allow more efficient searches.
-thinker_t thinkerclasscap;
+thinker_t thinkerclasscap[NUMTHCLASS];
 
 //******************************************************************************
 //p_user.c
@@ -476,6 +519,11 @@ visplane_t *visplanes[MAXVISPLANES];   // killough
 visplane_t *freetail;                  // killough
 visplane_t **freehead;     // killough
 
+visplane_t *visplanepool;              // VISPLANE_POOL planes, allocated on the first frame of a level
+int16_t numvisplanes;                  // visplanes used this frame
+int16_t peakvisplanes;                 // most visplanes in a frame since R_ResetRenderStats
+uint32_t visplaneoverflows;            // frames that needed more than VISPLANE_POOL visplanes
+
 
 
 // Clip values are the solid pixel bounding the range.
@@ -610,6 +658,15 @@ int32_t      st_randomnumber;
 int8_t st_palette;
 
 
+//******************************************************************************
+//tables.c
+//******************************************************************************
+
+// lookup table block cache statistics
+uint32_t ltcachehits;
+uint32_t ltcachemisses;
+
+
 //******************************************************************************
 //v_video.c
 //******************************************************************************
@@ -46,6 +46,7 @@
 #include "sounds.h"
 #include "g_game.h"
 #include "r_main.h"
+#include "z_zone.h"
 
 #include "globdata.h"
 
@@ -67,6 +68,9 @@
 #define HU_MSGX         0
 #define HU_MSGY         0
 
+#define HU_ZONEX        0
+#define HU_ZONEY        (HU_MSGY + HU_FONT_HEIGHT + 1)
+
 
 //
 // Builtin map names.
@@ -222,6 +226,10 @@ void HU_Start(void)
     while (*s)
         HUlib_addCharToTextLine(&_g->w_title, *(s++));
 
+    // create the zone memory widget below the messages
+    HUlib_initTextLine(&_g->w_zonestats[0], HU_ZONEX, HU_ZONEY);
+    HUlib_initTextLine(&_g->w_zonestats[1], HU_ZONEX, HU_ZONEY + HU_FONT_HEIGHT + 1);
+
 
     // now allow the heads-up display to run
     _g->headsupactive = true;
@@ -330,6 +338,12 @@ void HU_Drawer(void)
 
 
     HUlib_drawSText(&_g->w_message);
+
+    if (_g->zonestats_show)
+    {
+        HUlib_drawTextLine(&_g->w_zonestats[0]);
+        HUlib_drawTextLine(&_g->w_zonestats[1]);
+    }
 }
 
 
@@ -401,6 +415,23 @@ static void HUlib_addLineToSText(hu_stext_t* s)
 }
 
 
+//
+// HUlib_addMessageToTextLine()
+//
+// Replaces the text of a hu_textline_t widget
+//
+// Passed a hu_textline_t and a message string
+// Returns nothing
+//
+static void HUlib_addMessageToTextLine(hu_textline_t* t, const char* msg)
+{
+	HUlib_clearTextLine(t);
+
+	while (*msg)
+		HUlib_addCharToTextLine(t, *(msg++));
+}
+
+
 //
 // HUlib_addMessageToSText()
 //
@@ -418,6 +449,38 @@ static void HUlib_addMessageToSText(hu_stext_t* s, const char* msg)
 }
 
 
+//
+// HU_UpdateZoneStats()
+//
+// Fills the zone memory widget, in KB:
+// in use per purge tag and free,
+// then the largest free block, the fragmentation
+// and the peak of the level.
+//
+// Passed nothing, returns nothing
+//
+static void HU_UpdateZoneStats(void)
+{
+	zonestats_t stats;
+	char buffer[40];
+
+	Z_GetStats(&stats);
+
+	sprintf(buffer, "S%luK L%luK C%luK F%luK",
+		(unsigned long)(stats.tagbytes[1] >> 10),
+		(unsigned long)((stats.tagbytes[2] + stats.tagbytes[3]) >> 10),
+		(unsigned long)(stats.tagbytes[4] >> 10),
+		(unsigned long)(stats.freebytes >> 10));
+	HUlib_addMessageToTextLine(&_g->w_zonestats[0], buffer);
+
+	sprintf(buffer, "MAX%luK FRAG%u%% PEAK%luK",
+		(unsigned long)(stats.largestfree >> 10),
+		stats.fragmentation,
+		(unsigned long)(stats.peakused >> 10));
+	HUlib_addMessageToTextLine(&_g->w_zonestats[1], buffer);
+}
+
+
 //
 // HU_Ticker()
 //
@@ -460,4 +523,7 @@ void HU_Ticker(void)
             _g->message_dontfuckwithme = 0;
         }
     }
+
+    if (_g->zonestats_show)
+        HU_UpdateZoneStats();
 }
@@ -56,7 +56,9 @@
 #include "i_sound.h"
 #include "globdata.h"
 
+#if !defined __linux__
 #include <dos.h>
+#endif
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -70,6 +72,12 @@ static void I_Init(void)
 }
 
 
+#if defined __linux__
+static void tprintf(char *msg)
+{
+	printf("%s\n", msg);
+}
+#else
 static void SetTextPos(int32_t x, int32_t y)
 {
 	union REGS regs;
@@ -100,6 +108,7 @@ int x = 0;
 
 	printf("\n");
 }
+#endif
 
 extern int myargc;
 extern const char * const * myargv;
@@ -354,6 +354,20 @@ void I_Error (const char *error, ...)
 }
 
 
+void I_Exit (const char *message, ...)
+{
+	va_list argptr;
+
+	I_Shutdown();
+
+	va_start(argptr, message);
+	vprintf(message, argptr);
+	va_end(argptr);
+	printf("\n");
+	exit(0);
+}
+
+
 //**************************************************************************************
 //
 // Returns time in 1/35th second tics.
@@ -39,6 +39,7 @@
 void I_StartDisplay(void);
 int32_t I_GetTime(void);
 void I_Error (const char *error, ...);
+void I_Exit (const char *message, ...);  // like I_Error, but exits with status 0
 
 void I_InitScreen();
 
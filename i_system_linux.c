@@ -0,0 +1,330 @@
+/*-----------------------------------------------------------------------------
+ *
+ *
+ *  Copyright (C) 2023 Frenkel Smeijers
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *      Headless Linux implementation of i_system.h
+ *      There is no display and no keyboard. Every frame is timed,
+ *      the timings are reported at exit and the last frame
+ *      can be dumped to a PPM file, so the renderer and the
+ *      playsim can be benchmarked with -timedemo on a Linux host.
+ *
+ *      -frametimes          print the time of every frame at exit
+ *      -framedump <file>    write the last frame to <file> at exit
+ *
+ *-----------------------------------------------------------------------------*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "compiler.h"
+#include "d_main.h"
+#include "i_system.h"
+#include "globdata.h"
+
+
+static void I_Shutdown(void);
+
+
+extern int myargc;
+extern const char * const * myargv;
+
+static int16_t I_CheckParm(const char *check)
+{
+	for (int16_t i = 1; i < myargc; i++)
+		if (!strcasecmp(check, myargv[i]))
+			return i;
+
+	return 0;
+}
+
+
+//**************************************************************************************
+//
+// Timer code
+//
+
+static uint64_t I_GetMicroseconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+
+//
+// Returns time in 1/35th second tics.
+//
+
+int32_t I_GetTime(void)
+{
+	static uint64_t basetime;
+
+	uint64_t now = I_GetMicroseconds();
+
+	if (!basetime)
+		basetime = now;
+
+	return ((now - basetime) * TICRATE) / 1000000;
+}
+
+
+//**************************************************************************************
+//
+// Frame timing
+//
+
+static uint32_t *frametimes;
+static uint32_t  numframetimes;
+static uint32_t  maxframetimes;
+static uint64_t  lastframe;
+
+
+static void I_RecordFrameTime(void)
+{
+	uint64_t now = I_GetMicroseconds();
+
+	if (lastframe)
+	{
+		if (numframetimes == maxframetimes)
+		{
+			maxframetimes = maxframetimes ? maxframetimes * 2 : 4096;
+			frametimes = realloc(frametimes, maxframetimes * sizeof(*frametimes));
+			if (frametimes == NULL)
+			{
+				printf("I_RecordFrameTime: out of memory\n");
+				exit(1);
+			}
+		}
+
+		frametimes[numframetimes++] = now - lastframe;
+	}
+
+	lastframe = now;
+}
+
+
+static int I_CompareFrameTimes(const void *a, const void *b)
+{
+	uint32_t fa = *(const uint32_t *)a;
+	uint32_t fb = *(const uint32_t *)b;
+	return (fa > fb) - (fa < fb);
+}
+
+
+static void I_ReportFrameTimes(void)
+{
+	if (numframetimes == 0)
+		return;
+
+	if (I_CheckParm("-frametimes"))
+	{
+		for (uint32_t i = 0; i < numframetimes; i++)
+			printf("frame %5u: %6u us\n", i, frametimes[i]);
+	}
+
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < numframetimes; i++)
+		total += frametimes[i];
+
+	qsort(frametimes, numframetimes, sizeof(*frametimes), I_CompareFrameTimes);
+
+	printf("%u frames in %llu us: min %u us, avg %llu us, median %u us, 99%% %u us, max %u us\n",
+		numframetimes, (unsigned long long)total,
+		frametimes[0],
+		(unsigned long long)(total / numframetimes),
+		frametimes[numframetimes / 2],
+		frametimes[(numframetimes * 99) / 100],
+		frametimes[numframetimes - 1]);
+
+	free(frametimes);
+	frametimes = NULL;
+	numframetimes = maxframetimes = 0;
+}
+
+
+//**************************************************************************************
+//
+// Keyboard code
+//
+
+void I_InitScreen(void)
+{
+	// Also report when a demo ends with exit(0)
+	atexit(I_Shutdown);
+}
+
+
+void I_StartTic(void)
+{
+	// No keyboard, demos and timedemos only
+}
+
+
+//**************************************************************************************
+//
+// Screen code
+//
+
+static uint16_t  backBuffer[SCREENWIDTH * SCREENHEIGHT];
+static byte      palette[256 * 3];
+
+static int8_t newpal;
+
+uint16_t* I_GetBackBuffer(void)
+{
+	return &backBuffer[0];
+}
+
+
+void I_CopyBackBufferToBuffer(uint16_t* buffer)
+{
+	memcpy(buffer, backBuffer, sizeof(backBuffer));
+}
+
+
+void I_InitGraphics(void)
+{
+}
+
+
+void I_StartDisplay(void)
+{
+	_g->screen = &backBuffer[0];
+}
+
+
+void I_DrawBuffer(uint16_t *buffer)
+{
+	UNUSED(buffer);
+
+	// Only the screen wipe draws other buffers,
+	// don't count its time as the time of the next frame.
+	lastframe = 0;
+}
+
+
+static void I_UploadNewPalette(int8_t pal)
+{
+	char lumpName[9] = "PLAYPAL0";
+
+	if(_g->gamma == 0)
+		lumpName[7] = 0;
+	else
+		lumpName[7] = '0' + _g->gamma;
+
+	const uint8_t* palette_lump = W_GetLumpByName(lumpName);
+	memcpy(palette, &palette_lump[pal*256*3], sizeof(palette));
+	Z_Free(palette_lump);
+}
+
+
+//
+// I_FinishUpdate
+//
+
+#define NO_PALETTE_CHANGE 100
+
+void I_FinishUpdate (void)
+{
+	if (newpal != NO_PALETTE_CHANGE)
+	{
+		I_UploadNewPalette(newpal);
+		newpal = NO_PALETTE_CHANGE;
+	}
+
+	I_RecordFrameTime();
+}
+
+
+//
+// I_SetPalette
+//
+void I_SetPalette (int8_t pal)
+{
+	newpal = pal;
+}
+
+
+//
+// I_DumpFrame
+// Every short of the back buffer holds two pixels.
+//
+static void I_DumpFrame(const char *filename)
+{
+	FILE *fp = fopen(filename, "wb");
+	if (fp == NULL)
+	{
+		printf("I_DumpFrame: Can't open %s\n", filename);
+		return;
+	}
+
+	fprintf(fp, "P6\n%d %d\n255\n", SCREENWIDTH * 2, SCREENHEIGHT);
+
+	const byte *src = (const byte *)&backBuffer[0];
+	for (int32_t i = 0; i < SCREENWIDTH * 2 * SCREENHEIGHT; i++)
+		fwrite(&palette[src[i] * 3], 3, 1, fp);
+
+	fclose(fp);
+	printf("I_DumpFrame: Last frame written to %s\n", filename);
+}
+
+
+//**************************************************************************************
+//
+// Exit code
+//
+
+static void I_Shutdown(void)
+{
+	int16_t p = I_CheckParm("-framedump");
+	if (p && p < myargc - 1)
+		I_DumpFrame(myargv[p + 1]);
+
+	I_ReportFrameTimes();
+}
+
+
+void I_Error (const char *error, ...)
+{
+	va_list argptr;
+
+	va_start(argptr, error);
+	vprintf(error, argptr);
+	va_end(argptr);
+	printf("\n");
+	exit(1);
+}
+
+
+void I_Exit (const char *message, ...)
+{
+	va_list argptr;
+
+	va_start(argptr, message);
+	vprintf(message, argptr);
+	va_end(argptr);
+	printf("\n");
+	exit(0);
+}
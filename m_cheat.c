@@ -4,6 +4,7 @@
 #include "p_inter.h"
 #include "g_game.h"
 #include "globdata.h"
+#include "r_main.h"
 
 
 static void cheat_god(void);
@@ -19,6 +20,7 @@ static void cheat_goggles(void);
 static void cheat_exit(void);
 static void cheat_rockets(void);
 static void cheat_fps(void);
+static void cheat_zonestats(void);
 
 
 
@@ -51,6 +53,7 @@ static const c_cheat cheat_def[] =
     //Because Goldeneye!
     {"Enemy Rockets",   CHEAT_SEQ(KEYD_A,   KEYD_B,     KEYD_L,     KEYD_R,     KEYD_R,     KEYD_L,         KEYD_B,         KEYD_A),        cheat_rockets},
 	{"FPS Counter Ammo",CHEAT_SEQ(KEYD_A,   KEYD_B,     KEYD_L,     KEYD_UP,    KEYD_DOWN,  KEYD_B,         KEYD_LEFT,     KEYD_LEFT),      cheat_fps},
+    {"Zone Stats",      CHEAT_SEQ(KEYD_A,   KEYD_B,     KEYD_L,     KEYD_DOWN,  KEYD_UP,    KEYD_B,         KEYD_RIGHT,     KEYD_RIGHT),    cheat_zonestats},
 };
 
 static const uint32_t num_cheats = sizeof(cheat_def) / sizeof (c_cheat);
@@ -253,6 +256,26 @@ static void cheat_rockets()
     }
 }
 
+static void cheat_zonestats()
+{
+    _g->zonestats_show = !_g->zonestats_show;
+    if(_g->zonestats_show)
+    {
+        _g->player.message = STSTR_ZONEON;
+
+        if(_g->fileZoneStats)
+        {
+            Z_DumpStats(_g->fileZoneStats, "cheat");
+            R_DumpRenderStats(_g->fileZoneStats);
+            P_DumpThingPoolStats(_g->fileZoneStats);
+        }
+    }
+    else
+    {
+        _g->player.message = STSTR_ZONEOFF;
+    }
+}
+
 static void cheat_fps()
 {
     _g->fps_show = !_g->fps_show;
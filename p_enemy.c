@@ -98,6 +98,9 @@ static void P_RecursiveSound(sector_t *sec, int32_t soundblocks,
   sec->soundtraversed = soundblocks+1;
   P_SetTarget(&sec->soundtarget, soundtarget);
 
+  for (mobj_t *mo = sec->thinglist; mo; mo = mo->snext)
+    P_WakeMobj(mo);
+
   for (i=0; i<sec->linecount; i++)
     {
       sector_t *other;
@@ -132,6 +135,25 @@ void P_NoiseAlert(mobj_t *emitter)
   P_RecursiveSound(emitter->subsector->sector, 0, emitter);
 }
 
+//
+// P_WakeDormantMobjs
+// Called when the player enters another sector,
+// wakes up the dormant monsters that might see it.
+//
+void P_WakeDormantMobjs(const sector_t *sec)
+{
+  thinker_t *th = NULL;
+
+  while ((th = P_NextThinker(th)) != NULL)
+    if (th->function == P_MobjDormantThinker)
+    {
+      mobj_t *mo = (mobj_t *)th;
+
+      if (!P_RejectBlocks(mo->subsector->sector, sec))
+        P_WakeMobj(mo);
+    }
+}
+
 //
 // P_CheckMeleeRange
 //
@@ -506,7 +528,7 @@ static fixed_t P_AvoidDropoff(mobj_t *actor)
   _g->validcount++;
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      P_BlockLinesIterator(bx, by, PIT_AvoidDropoff);  // all contacted lines
+      P_BlockLinesInBoxIterator(bx, by, PIT_AvoidDropoff);  // all contacted lines
 
   return _g->dropoff_deltax | _g->dropoff_deltay;   // Non-zero if movement prescribed
 }
@@ -629,6 +651,31 @@ static boolean P_LookForTargets(mobj_t *actor, int32_t allaround)
 // ACTION ROUTINES
 //
 
+//
+// P_ParkIdleMobj
+// A monster that hasn't heard anything and whose sector can't see
+// the player's sector according to REJECT becomes dormant.
+// Until something wakes it up, A_Look would fail.
+//
+
+static void P_ParkIdleMobj(mobj_t *actor, const mobj_t *targ)
+{
+    if (!_g->rejectvalid || !_g->playeringame)
+        return;
+
+    if (actor->thinker.function != P_MobjThinker || actor->tics <= 0)
+        return;
+
+    if (targ && (targ->flags & MF_SHOOTABLE))
+        return;
+
+    if (actor->momx | actor->momy | actor->momz || actor->z != actor->floorz || actor->flags & MF_SKULLFLY)
+        return;
+
+    if (P_RejectBlocks(actor->subsector->sector, _g->player.mo->subsector->sector))
+        actor->thinker.function = P_MobjDormantThinker;
+}
+
 //
 // A_Look
 // Stay in state until a player is sighted.
@@ -663,7 +710,10 @@ void A_Look(mobj_t *actor)
 
 
     if ( (!seen) && (!P_LookForPlayers (actor, false)))
+    {
+        P_ParkIdleMobj(actor, targ);
         return;
+    }
 
 
 
@@ -1012,8 +1062,8 @@ void A_BossDeath(mobj_t *mo)
 
     // scan the remaining thinkers to see
     // if all bosses are dead
-    for (th = _g->thinkerclasscap.next; th != &_g->thinkerclasscap; th = th->next)
-        if (th->function == P_MobjThinker)
+    for (th = _g->thinkerclasscap[th_main].next; th != &_g->thinkerclasscap[th_main]; th = th->next)
+        if (th->function == P_MobjThinker || th->function == P_MobjDormantThinker)
         {
             mobj_t *mo2 = (mobj_t *) th;
             if (mo2 != mo && mo2->type == mo->type && mo2->health > 0)
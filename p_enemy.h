@@ -39,8 +39,10 @@
 #define __P_ENEMY__
 
 #include "p_mobj.h"
+#include "r_defs.h"
 
 void P_NoiseAlert (mobj_t *emmiter);
+void P_WakeDormantMobjs(const sector_t *sec);
 
 
 // ********************************************************************
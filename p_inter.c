@@ -612,6 +612,8 @@ void P_DamageMobj(mobj_t *target,mobj_t *inflictor, mobj_t *source, int32_t dama
   if (target->health <= 0)
     return;
 
+  P_WakeMobj(target);
+
   if (target->flags & MF_SKULLFLY)
     target->momx = target->momy = target->momz = 0;
 
@@ -41,6 +41,7 @@
 #include "r_main.h"
 #include "p_spec.h"
 #include "p_tick.h"
+#include "p_map.h"
 
 #include "globdata.h"
 
@@ -67,6 +68,8 @@ static void T_FireFlicker (fireflicker_t* flick)
 
   amount = (P_Random()&3)*16;
 
+  R_DirtySector(flick->sector);
+
   if (flick->sector->lightlevel - amount < flick->minlight)
     flick->sector->lightlevel = flick->minlight;
   else
@@ -88,6 +91,8 @@ static void T_LightFlash (lightflash_t* flash)
   if (--flash->count)
     return;
 
+  R_DirtySector(flash->sector);
+
   if (flash->sector->lightlevel == flash->maxlight)
   {
     flash-> sector->lightlevel = flash->minlight;
@@ -102,18 +107,40 @@ static void T_LightFlash (lightflash_t* flash)
 }
 
 //
-// T_StrobeFlash()
+// P_ParkLight()
 //
-// Strobe light flashing action routine, called once per tick
+// Takes a glowing or strobing light off the thinker list
+// while REJECT says the player can't see its sector.
+// These lights don't use P_Random, and only the linedef
+// lighting handlers read them, so P_WakeParkedLights can
+// replay the missed tics later without breaking demo sync.
+//
+// Passed the thinker, its sector and where to note the tic
+// Returns true if the light was parked
+//
+static boolean P_ParkLight(thinker_t* th, const sector_t* sector, int32_t* parkedtic)
+{
+  if (!_g->rejectvalid || _g->nopvs || !_g->player.mo)
+    return false;
+
+  if (!P_RejectBlocks(_g->player.mo->subsector->sector, sector))
+    return false;
+
+  *parkedtic = _g->leveltime;
+  P_ChangeThinkerClass(th, th_parked);
+  return true;
+}
+
+//
+// P_ToggleStrobeFlash()
+//
+// Switches a strobing light between its two levels
 //
 // Passed a strobe_t structure containing light levels and timing
 // Returns nothing
 //
-static void T_StrobeFlash (strobe_t*   flash)
+static void P_ToggleStrobeFlash (strobe_t* flash)
 {
-  if (--flash->count)
-    return;
-
   if (flash->sector->lightlevel == flash->minlight)
   {
     flash-> sector->lightlevel = flash->maxlight;
@@ -127,15 +154,35 @@ static void T_StrobeFlash (strobe_t*   flash)
 }
 
 //
-// T_Glow()
+// T_StrobeFlash()
 //
-// Glowing light action routine, called once per tick
+// Strobe light flashing action routine, called once per tick
 //
-// Passed a glow_t structure containing light levels and timing
+// Passed a strobe_t structure containing light levels and timing
 // Returns nothing
 //
+static void T_StrobeFlash (strobe_t*   flash)
+{
+  if (P_ParkLight(&flash->thinker, flash->sector, &flash->parkedtic))
+    return;
 
-static void T_Glow(glow_t* g)
+  if (--flash->count)
+    return;
+
+  R_DirtySector(flash->sector);
+
+  P_ToggleStrobeFlash(flash);
+}
+
+//
+// P_StepGlow()
+//
+// Moves a glowing light one step towards its other level
+//
+// Passed a glow_t structure containing light levels and timing
+// Returns nothing
+//
+static void P_StepGlow(glow_t* g)
 {
   switch(g->direction)
   {
@@ -161,6 +208,129 @@ static void T_Glow(glow_t* g)
   }
 }
 
+//
+// T_Glow()
+//
+// Glowing light action routine, called once per tick
+//
+// Passed a glow_t structure containing light levels and timing
+// Returns nothing
+//
+
+static void T_Glow(glow_t* g)
+{
+  if (P_ParkLight(&g->thinker, g->sector, &g->parkedtic))
+    return;
+
+  R_DirtySector(g->sector);
+
+  P_StepGlow(g);
+}
+
+//
+// P_GlowPeriod()
+//
+// A glow steps through the levels strictly between minlight and
+// maxlight that are a multiple of GLOWSPEED away from its own level,
+// and pauses a tic at either end, so it repeats every two passes.
+// A level outside that range is left within GLOW_SETTLE tics.
+//
+// Passed a glow_t structure containing light levels and timing
+// Returns the period in tics
+//
+
+#define GLOW_SETTLE (256 / GLOWSPEED)
+
+static int32_t P_GlowPeriod(const glow_t* g)
+{
+  int32_t lowest = g->minlight + 1 +
+    ((g->sector->lightlevel - g->minlight - 1) % GLOWSPEED + GLOWSPEED) % GLOWSPEED;
+
+  int32_t levels = lowest < g->maxlight ? (g->maxlight - 1 - lowest) / GLOWSPEED + 1 : 0;
+
+  return levels > 1 ? 2 * levels : 2;
+}
+
+//
+// P_WakeParkedLights()
+//
+// Replays the tics that parked lights have missed
+// and puts them back on the thinker list.
+//
+// Passed the sector the player has entered, wakes the lights
+// it might see, or NULL to wake all before light levels are read
+// Returns nothing
+//
+void P_WakeParkedLights(const sector_t* sec)
+{
+  thinker_t* cap = &_g->thinkerclasscap[th_parked];
+  thinker_t* th = cap->next;
+
+  while (th != cap)
+  {
+    thinker_t* next = th->next;
+
+    if (th->function == T_StrobeFlash)
+    {
+      strobe_t* flash = (strobe_t*)th;
+
+      if (!sec || !P_RejectBlocks(sec, flash->sector))
+      {
+        int32_t tics = _g->leveltime - flash->parkedtic;
+
+        // Skip from one toggle to the next. After two toggles the
+        // strobe is in its cycle, skip the whole periods then.
+        // It repeats every darktime + brighttime tics, or every
+        // brighttime tics when both levels are equal.
+        for (int16_t toggles = 1; tics >= flash->count; toggles++)
+        {
+          tics -= flash->count;
+          P_ToggleStrobeFlash(flash);
+
+          if (toggles == 2)
+          {
+            if (flash->minlight == flash->maxlight)
+              tics %= flash->brighttime;
+            else
+              tics %= flash->darktime + flash->brighttime;
+          }
+        }
+
+        flash->count -= tics;
+
+        R_DirtySector(flash->sector);
+        P_ChangeThinkerClass(th, th_lighting);
+      }
+    }
+    else
+    {
+      glow_t* g = (glow_t*)th;
+
+      if (!sec || !P_RejectBlocks(sec, g->sector))
+      {
+        int32_t tics = _g->leveltime - g->parkedtic;
+
+        // Settle into the cycle first, then skip the whole periods.
+        if (tics > GLOW_SETTLE)
+        {
+          for (int32_t i = 0; i < GLOW_SETTLE; i++)
+            P_StepGlow(g);
+
+          tics = (tics - GLOW_SETTLE) % P_GlowPeriod(g);
+        }
+
+        for ( ; tics > 0; tics--)
+          P_StepGlow(g);
+
+        R_DirtySector(g->sector);
+        P_ChangeThinkerClass(th, th_lighting);
+      }
+    }
+
+    th = next;
+  }
+}
+
 //////////////////////////////////////////////////////////
 //
 // Sector lighting type spawners
@@ -245,7 +415,7 @@ void P_SpawnStrobeFlash
 
   flash = Z_CallocLevSpec(sizeof(*flash));
 
-  P_AddThinker (&flash->thinker);
+  P_AddThinkerToClass (&flash->thinker, th_lighting);
 
   flash->sector = sector;
   flash->darktime = fastOrSlow;
@@ -280,7 +450,7 @@ void P_SpawnGlowingLight(sector_t*  sector)
 
   g = Z_CallocLevSpec(sizeof(*g));
 
-  P_AddThinker(&g->thinker);
+  P_AddThinkerToClass(&g->thinker, th_lighting);
 
   g->sector = sector;
   g->minlight = P_FindMinSurroundingLight(sector,sector->lightlevel);
@@ -312,6 +482,9 @@ int32_t EV_StartLightStrobing(const line_t* line)
   int32_t   secnum;
   sector_t* sec;
 
+  // P_FindMinSurroundingLight reads the levels of the neighbours
+  P_WakeParkedLights(NULL);
+
   secnum = -1;
   // start lights strobing in all sectors tagged same as line
   while ((secnum = P_FindSectorFromLineTag(line,secnum)) >= 0)
@@ -340,6 +513,8 @@ int32_t EV_TurnTagLightsOff(const line_t* line)
 {
   int32_t j;
 
+  P_WakeParkedLights(NULL);
+
   // search sectors for those with same tag as activating line
 
   // killough 10/98: replaced inefficient search with fast search
@@ -372,6 +547,8 @@ int32_t EV_LightTurnOn(const line_t *line, int32_t bright)
 {
   int32_t i;
 
+  P_WakeParkedLights(NULL);
+
   // search all sectors for ones with same tag as activating line
 
   // killough 10/98: replace inefficient search with fast search
@@ -410,6 +587,8 @@ int32_t EV_LightTurnOnPartway(const line_t *line, fixed_t level)
 {
   int32_t i;
 
+  P_WakeParkedLights(NULL);
+
   if (level < 0)          // clip at extremes
     level = 0;
   if (level > FRACUNIT)
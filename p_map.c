@@ -482,7 +482,7 @@ boolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      if (!P_BlockLinesIterator (bx,by,PIT_CheckLine))
+      if (!P_BlockLinesInBoxIterator (bx,by,PIT_CheckLine))
         return false; // doesn't fit
 
   return true;
@@ -1397,6 +1397,11 @@ boolean P_CheckSector(sector_t* sector,boolean crunch)
   {
   msecnode_t *n;
 
+#if defined OPENING_CACHE
+  // The height of the sector has changed
+  _g->sectorgenerations[sector - _g->sectors] = ++_g->heightgeneration;
+#endif
+
   _g->nofit = false;
   _g->crushchange = crunch;
 
@@ -1646,7 +1651,7 @@ void P_CreateSecNodeList(mobj_t* thing,fixed_t x,fixed_t y)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      P_BlockLinesIterator(bx,by,PIT_GetSectors);
+      P_BlockLinesInBoxIterator(bx,by,PIT_GetSectors);
 
   // Add the sector of the (x,y) point to sector_list.
 
@@ -42,6 +42,8 @@
 #include "p_maputl.h"
 #include "p_map.h"
 #include "p_setup.h"
+#include "p_enemy.h"
+#include "p_spec.h"
 
 #include "globdata.h"
 
@@ -157,9 +159,27 @@ fixed_t PUREFUNC P_InterceptVector2(const divline_t *v2, const divline_t *v1)
 // P_LineOpening
 // Sets opentop and openbottom to the window
 // through a two sided line.
-// OPTIMIZE: keep this precalculated
+// Openings are kept per line until a floor or ceiling moves.
 //
 
+static void P_ComputeLineOpening(void)
+{
+    if (_g->openfrontsector->ceilingheight < _g->openbacksector->ceilingheight)
+        _g->opentop = _g->openfrontsector->ceilingheight;
+    else
+        _g->opentop = _g->openbacksector->ceilingheight;
+
+    if (_g->openfrontsector->floorheight > _g->openbacksector->floorheight)
+    {
+        _g->openbottom = _g->openfrontsector->floorheight;
+        _g->lowfloor = _g->openbacksector->floorheight;
+    }
+    else
+    {
+        _g->openbottom = _g->openbacksector->floorheight;
+        _g->lowfloor = _g->openfrontsector->floorheight;
+    }
+}
 
 void P_LineOpening(const line_t *linedef)
 {
@@ -172,21 +192,33 @@ void P_LineOpening(const line_t *linedef)
     _g->openfrontsector = LN_FRONTSECTOR(linedef);
     _g->openbacksector = LN_BACKSECTOR(linedef);
 
-    if (_g->openfrontsector->ceilingheight < _g->openbacksector->ceilingheight)
-        _g->opentop = _g->openfrontsector->ceilingheight;
-    else
-        _g->opentop = _g->openbacksector->ceilingheight;
+#if defined OPENING_CACHE
+    lineopening_t *lo = &_g->lineopenings[linedef - _g->lines];
 
-    if (_g->openfrontsector->floorheight > _g->openbacksector->floorheight)
+    // Only the last height change of either sector matters.
+    uint32_t frontgeneration = _g->sectorgenerations[_g->openfrontsector - _g->sectors];
+    uint32_t backgeneration  = _g->sectorgenerations[_g->openbacksector - _g->sectors];
+    uint32_t generation = frontgeneration > backgeneration ? frontgeneration : backgeneration;
+
+    if (lo->generation != generation)
     {
-        _g->openbottom = _g->openfrontsector->floorheight;
-        _g->lowfloor = _g->openbacksector->floorheight;
+        P_ComputeLineOpening();
+
+        lo->opentop    = _g->opentop;
+        lo->openbottom = _g->openbottom;
+        lo->lowfloor   = _g->lowfloor;
+        lo->generation = generation;
     }
     else
     {
-        _g->openbottom = _g->openbacksector->floorheight;
-        _g->lowfloor = _g->openfrontsector->floorheight;
+        _g->opentop    = lo->opentop;
+        _g->openbottom = lo->openbottom;
+        _g->lowfloor   = lo->lowfloor;
     }
+#else
+    P_ComputeLineOpening();
+#endif
+
     _g->openrange = _g->opentop - _g->openbottom;
 }
 
@@ -204,6 +236,8 @@ void P_LineOpening(const line_t *linedef)
 
 void P_UnsetThingPosition (mobj_t *thing)
 {
+  R_DirtyMobj(thing);
+
   if (!(thing->flags & MF_NOSECTOR))
     {
       /* invisible things don't need to be in sector list
@@ -264,7 +298,18 @@ void P_UnsetThingPosition (mobj_t *thing)
 
 void P_SetThingPosition(mobj_t *thing)
 {                                                      // link into subsector
-  subsector_t *ss = thing->subsector = R_PointInSubsector(thing->x, thing->y);
+  subsector_t *ss = R_PointInSubsector(thing->x, thing->y);
+
+  if (thing == _g->player.mo && thing->subsector && thing->subsector->sector != ss->sector)
+  {
+    P_WakeDormantMobjs(ss->sector);
+    P_WakeParkedLights(ss->sector);
+  }
+
+  thing->subsector = ss;
+
+  R_DirtyMobj(thing);
+
   if (!(thing->flags & MF_NOSECTOR))
     {
       // invisible things don't go into the sector links
@@ -337,13 +382,23 @@ void P_SetThingPosition(mobj_t *thing)
 // to it.
 //
 // killough 5/3/98: reformatted, cleaned up
+//
+// When bbox is set, lines whose bounding box doesn't
+// overlap it are skipped without looking at them.
+// Such lines aren't marked, they would be skipped again.
+//
 
-boolean P_BlockLinesIterator(int32_t x, int32_t y, boolean func(const line_t*))
+static boolean P_IterateBlockLines(int32_t x, int32_t y, const fixed_t* bbox, boolean func(const line_t*))
 {
 
     if (x<0 || y<0 || x>=_g->bmapwidth || y>=_g->bmapheight)
         return true;
 
+#if defined COMPACT_BLOCKMAP
+    const int32_t block = y*_g->bmapwidth+x;
+    const uint16_t* list = _g->blocklines + _g->blockstart[block];
+    const uint16_t* end  = _g->blocklines + _g->blockstart[block+1];
+#else
     const int32_t offset = _g->blockmap[y*_g->bmapwidth+x];
     const int16_t* list = _g->blockmaplump+offset;     // original was reading         // phares
 
@@ -355,13 +410,33 @@ boolean P_BlockLinesIterator(int32_t x, int32_t y, boolean func(const line_t*))
     // don't consider linedef 0. For safety this should be qualified.
 
     list++;     // skip 0 starting delimiter                      // phares
+#endif
 
     const int32_t vcount = _g->validcount;
 
+#if defined COMPACT_BLOCKMAP
+    for ( ; list < end ; list++)
+#else
     for ( ; *list != -1 ; list++)                                   // phares
+#endif
     {
         const int32_t lineno = *list;
 
+#if defined COMPACT_BLOCKMAP
+        // Without the packed boxes the test would touch the far
+        // line_t, the PIT_ functions do it themselves then.
+        if (bbox)
+        {
+            const fixed_t* lbox = _g->lineboxes[lineno].bbox;
+
+            if (bbox[BOXRIGHT]  <= lbox[BOXLEFT]   ||
+                bbox[BOXLEFT]   >= lbox[BOXRIGHT]  ||
+                bbox[BOXTOP]    <= lbox[BOXBOTTOM] ||
+                bbox[BOXBOTTOM] >= lbox[BOXTOP])
+                continue;
+        }
+#endif
+
         linedata_t *lt = &_g->linedata[lineno];
 
         if (lt->validcount == vcount)
@@ -378,6 +453,22 @@ boolean P_BlockLinesIterator(int32_t x, int32_t y, boolean func(const line_t*))
     return true;  // everything was checked
 }
 
+boolean P_BlockLinesIterator(int32_t x, int32_t y, boolean func(const line_t*))
+{
+    return P_IterateBlockLines(x, y, NULL, func);
+}
+
+//
+// P_BlockLinesInBoxIterator
+// Only calls func for lines that overlap tmbbox,
+// for PIT_ functions that ignore the other lines.
+//
+
+boolean P_BlockLinesInBoxIterator(int32_t x, int32_t y, boolean func(const line_t*))
+{
+    return P_IterateBlockLines(x, y, _g->tmbbox, func);
+}
+
 //
 // P_BlockThingsIterator
 //
@@ -44,6 +44,17 @@
 #define MAPBLOCKSHIFT   (FRACBITS+7)
 #define MAPBTOFRAC      (MAPBLOCKSHIFT-FRACBITS)
 
+// Decode the line lists of the blockmap at level load
+// and keep the bounding boxes of the lines next to each other.
+#if !defined _M_I86
+#define COMPACT_BLOCKMAP
+#endif
+
+typedef struct
+{
+  fixed_t bbox[4];
+} linebox_t;
+
 #define PT_ADDLINES     1
 #define PT_ADDTHINGS    2
 
@@ -83,10 +94,25 @@ int32_t     P_BoxOnLineSide (const fixed_t *tmbox, const line_t *ld);
 /* cph - old compatibility version below */
 fixed_t P_InterceptVector2(const divline_t *v2, const divline_t *v1);
 
+// Host builds only, at 16 bytes per line
+// the opening cache is too big for a 16-bit build.
+#if !defined _M_I86
+#define OPENING_CACHE
+#endif
+
+typedef struct
+{
+  fixed_t  opentop;
+  fixed_t  openbottom;
+  fixed_t  lowfloor;
+  uint32_t generation;
+} lineopening_t;
+
 void    P_LineOpening (const line_t *linedef);
 void    P_UnsetThingPosition(mobj_t *thing);
 void    P_SetThingPosition(mobj_t *thing);
 boolean P_BlockLinesIterator (int32_t x, int32_t y, boolean func(const line_t *));
+boolean P_BlockLinesInBoxIterator (int32_t x, int32_t y, boolean func(const line_t *));
 boolean P_BlockThingsIterator(int32_t x, int32_t y, boolean func(mobj_t *));
 boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                        int32_t flags, boolean trav(intercept_t *));
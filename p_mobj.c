@@ -54,6 +54,8 @@
 
 void A_CyberAttack(mobj_t *actor);
 
+static void P_MobjBrainlessThinker(mobj_t* mobj);
+
 
 //
 // P_SetMobjState
@@ -78,6 +80,7 @@ boolean P_SetMobjState(mobj_t* mobj, statenum_t state)
         mobj->tics = st->tics;
         mobj->sprite = st->sprite;
         mobj->frame = st->frame;
+        R_DirtyMobj(mobj);
 
         // Modified handling.
         // Call action functions when the state is set
@@ -100,6 +103,13 @@ boolean P_SetMobjState(mobj_t* mobj, statenum_t state)
 
     } while (!mobj->tics);
 
+    // Wake up an inert thing
+    if (!mobj->thinker.function && mobj->tics != -1)
+    {
+        mobj->thinker.function = P_MobjBrainlessThinker;
+        P_ChangeThinkerClass(&mobj->thinker, th_brainless);
+    }
+
     return true;
 }
 
@@ -542,6 +552,8 @@ void P_MobjThinker (mobj_t* mobj)
         P_ZMovement(mobj);
         if (mobj->thinker.function != P_MobjThinker) // cph - Must've been removed
             return;       // killough - mobj was removed
+
+        R_DirtyMobj(mobj);
     }
 
     // cycle through states,
@@ -585,6 +597,56 @@ void P_MobjThinker (mobj_t* mobj)
 }
 
 
+//
+// P_MobjDormantThinker
+// Thinker of an idle monster that can't see the player, set by A_Look.
+// The monster keeps its place in the thinker list and its state timers
+// keep running, so when it is woken up it looks for the player in the
+// same tic and in the same order as before, and demos stay in sync.
+// Its A_Look calls are skipped, they would fail.
+//
+
+void P_MobjDormantThinker(mobj_t* mobj)
+{
+    if (mobj->momx | mobj->momy | mobj->momz || mobj->z != mobj->floorz || mobj->flags & MF_SKULLFLY)
+    {
+        P_WakeMobj(mobj);
+        P_MobjThinker(mobj);
+        return;
+    }
+
+    if (!--mobj->tics)
+    {
+        const state_t* st = &states[mobj->state->nextstate];
+
+        if (st->action == A_Look && st->tics > 0)
+        {
+            mobj->state = st;
+            mobj->tics = st->tics;
+            mobj->sprite = st->sprite;
+            mobj->frame = st->frame;
+            R_DirtyMobj(mobj);
+        }
+        else
+        {
+            P_WakeMobj(mobj);
+            P_SetMobjState(mobj, mobj->state->nextstate);
+        }
+    }
+}
+
+//
+// P_WakeMobj
+// Called when a dormant monster hears a noise or is damaged.
+//
+
+void P_WakeMobj(mobj_t* mobj)
+{
+    if (mobj->thinker.function == P_MobjDormantThinker)
+        mobj->thinker.function = P_MobjThinker;
+}
+
+
 //Thinker function for stuff that doesn't need to do anything
 //interesting.
 //Just cycles through the states. Allows sprite animation to work.
@@ -602,6 +664,64 @@ static void P_MobjBrainlessThinker(mobj_t* mobj)
         if (!mobj->tics)
             P_SetMobjState (mobj, mobj->state->nextstate);
     }
+
+    // Stopped cycling, skip it until P_SetMobjState wakes it.
+    if (mobj->tics == -1 && mobj->thinker.function == P_MobjBrainlessThinker)
+    {
+        mobj->thinker.function = NULL;
+        P_ChangeThinkerClass(&mobj->thinker, th_inert);
+    }
+}
+
+
+//
+// The states of things that aren't monsters don't have actions,
+// so they can't change the outcome of other thinkers.
+//
+
+#if !defined _M_I86
+//
+// P_CheckBrainlessStates
+// Brainless mobjs run after th_main. An action in one of their states
+//  could call P_Random out of spawn order and break demo sync.
+//
+void P_CheckBrainlessStates(void)
+{
+    for (int16_t type = MT_MISC0; type < NUMMOBJTYPES; type++)
+    {
+        const mobjinfo_t* info = &mobjinfo[type];
+
+        const int32_t entries[] =
+        {
+            info->spawnstate, info->seestate, info->painstate, info->meleestate,
+            info->missilestate, info->deathstate, info->xdeathstate
+        };
+
+        for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+        {
+            statenum_t state = entries[i];
+
+            // The chains end in S_NULL or loop, NUMSTATES steps cover both.
+            for (int32_t steps = 0; state != S_NULL && steps < NUMSTATES; steps++)
+            {
+                if (states[state].action)
+                    I_Error("P_CheckBrainlessStates: state %d of thing type %d has an action", state, type);
+
+                state = states[state].nextstate;
+            }
+        }
+    }
+}
+#endif
+
+static th_class P_ThinkerClassForFunction(think_t function)
+{
+    if (function == P_MobjBrainlessThinker)
+        return th_brainless;
+    else if (function == NULL)
+        return th_inert;
+    else
+        return th_main;
 }
 
 
@@ -621,34 +741,88 @@ static think_t P_ThinkerFunctionForType(mobjtype_t type, mobj_t* mobj)
 }
 
 //
-// P_SpawnMobj
+// Thing pool
+// Every mobj comes from the pool and goes back to it when removed.
+// Free mobjs are linked through snext, they are no longer in a sector.
+// When the pool runs dry it grows by a chunk of mobjs.
 //
 
-static mobj_t* P_NewMobj()
-{
-    mobj_t* mobj = NULL;
+#define THING_POOL_CHUNK 16
 
-    for(int32_t i = _g->thingPoolSize-1; i >= 0; i--)
+static void P_AddToThingPool(mobj_t* mobjs, int32_t count)
+{
+    // Hand out the lowest address first
+    for (int32_t i = count - 1; i >= 0; i--)
     {
-        if(_g->thingPool[i].type == MT_NOTHING)
-        {
-            mobj = &_g->thingPool[i];
-            memset (mobj, 0, sizeof (*mobj));
-
-            mobj->flags = MF_POOLED;
-            return mobj;
-        }
+        mobjs[i].type  = MT_NOTHING;
+        mobjs[i].snext = _g->thingPoolFree;
+        _g->thingPoolFree = &mobjs[i];
     }
 
-    if(mobj == NULL)
+    _g->thingPoolSize += count;
+}
+
+//
+// P_InitThingPool
+// Called when the things of a level are loaded,
+// the pool is freed at the end of the level.
+//
+
+void P_InitThingPool(int32_t size)
+{
+    _g->thingPoolFree   = NULL;
+    _g->thingPoolSize   = 0;
+    _g->thingPoolUsed   = 0;
+    _g->thingPoolPeak   = 0;
+    _g->thingPoolChunks = 0;
+
+    P_AddToThingPool(Z_MallocLevel(size * sizeof(mobj_t), NULL), size);
+}
+
+void P_DumpThingPoolStats(FILE* fp)
+{
+    fprintf(fp, "Things: %lu of %lu in use, peak %lu, %u chunks of %u added\n",
+        (unsigned long)_g->thingPoolUsed, (unsigned long)_g->thingPoolSize,
+        (unsigned long)_g->thingPoolPeak, _g->thingPoolChunks, THING_POOL_CHUNK);
+    fflush(fp);
+}
+
+//
+// P_SpawnMobj
+//
+
+static mobj_t* P_NewMobj()
+{
+    if (!_g->thingPoolFree)
     {
-        mobj = Z_MallocLevel(sizeof(*mobj), NULL);
-        memset (mobj, 0, sizeof (*mobj));
+        P_AddToThingPool(Z_MallocLevel(THING_POOL_CHUNK * sizeof(mobj_t), NULL), THING_POOL_CHUNK);
+        _g->thingPoolChunks++;
     }
 
+    mobj_t* mobj = _g->thingPoolFree;
+    _g->thingPoolFree = mobj->snext;
+
+    memset (mobj, 0, sizeof (*mobj));
+
+    if (++_g->thingPoolUsed > _g->thingPoolPeak)
+        _g->thingPoolPeak = _g->thingPoolUsed;
+
     return mobj;
 }
 
+//
+// P_FreeMobj
+// Called by the thinker loop once a removed mobj has had its turn.
+//
+
+void P_FreeMobj(mobj_t* mobj)
+{
+    mobj->type  = MT_NOTHING;
+    mobj->snext = _g->thingPoolFree;
+    _g->thingPoolFree = mobj;
+    _g->thingPoolUsed--;
+}
+
 mobj_t* P_SpawnMobj(fixed_t x,fixed_t y,fixed_t z,mobjtype_t type)
 {
     const state_t*    st;
@@ -698,7 +872,7 @@ mobj_t* P_SpawnMobj(fixed_t x,fixed_t y,fixed_t z,mobjtype_t type)
     mobj->thinker.function = P_ThinkerFunctionForType(type, mobj);
 
     mobj->target = mobj->tracer = mobj->lastenemy = NULL;
-    P_AddThinker (&mobj->thinker);
+    P_AddThinkerToClass (&mobj->thinker, P_ThinkerClassForFunction(mobj->thinker.function));
     if (!((mobj->flags ^ MF_COUNTKILL) & (MF_FRIEND | MF_COUNTKILL)))
         _g->totallive++;
     return mobj;
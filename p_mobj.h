@@ -37,6 +37,8 @@
 #define __P_MOBJ__
 
 // Basics.
+#include <stdio.h>
+
 #include "tables.h"
 #include "m_fixed.h"
 
@@ -192,8 +194,6 @@
 // Neither a cacodemon nor a missile.
 #define MF_SKULLFLY     (uint32_t)(0x0000000001000000)
 
-#define MF_POOLED      (uint32_t)(0x0000000010000000)
-
 #define MF_FRIEND       (uint32_t)(0x0000000080000000)
 
 
@@ -314,11 +314,17 @@ typedef struct mobj_s
 
 
 void    P_RespawnSpecials(void);
+void    P_InitThingPool(int32_t size);
+void    P_CheckBrainlessStates(void);
+void    P_DumpThingPoolStats(FILE* fp);
 mobj_t  *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type);
+void    P_FreeMobj(mobj_t *mobj);
 void    P_RemoveMobj(mobj_t *th);
 boolean P_SetMobjState(mobj_t *mobj, statenum_t state);
 
 void    P_MobjThinker(mobj_t *mobj);
+void    P_MobjDormantThinker(mobj_t *mobj);
+void    P_WakeMobj(mobj_t *mobj);
 
 void    P_SpawnPuff(fixed_t x, fixed_t y, fixed_t z);
 void    P_SpawnBlood(fixed_t x, fixed_t y, fixed_t z, int32_t damage);
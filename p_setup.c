@@ -156,6 +156,9 @@ static void P_LoadSectors (int16_t lump)
 
   _g->numsectors = W_LumpLength (lump) / sizeof(mapsector_t);
   _g->sectors = Z_CallocLevel(_g->numsectors * sizeof(sector_t));
+#if defined OPENING_CACHE
+  _g->sectorgenerations = Z_CallocLevel(_g->numsectors * sizeof(uint32_t));
+#endif
   data = W_GetLumpByNumAutoFree (lump); // cph - wad lump handling updated
 
   for (i=0; i<_g->numsectors; i++)
@@ -259,13 +262,7 @@ static void P_LoadThings (int16_t lump)
     if ((!data) || (!numthings))
         I_Error("P_LoadThings: no things in level");
 
-    _g->thingPool = Z_CallocLevel(numthings * sizeof(mobj_t));
-    _g->thingPoolSize = numthings;
-
-    for(int32_t i = 0; i < numthings; i++)
-    {
-        _g->thingPool[i].type = MT_NOTHING;
-    }
+    P_InitThingPool(numthings);
 
     for (i=0; i<numthings; i++)
     {
@@ -299,9 +296,18 @@ static void P_LoadLineDefs (int16_t lump)
 
     _g->linedata = Z_CallocLevel(_g->numlines * sizeof(linedata_t));
 
+#if defined OPENING_CACHE
+    _g->lineopenings = Z_MallocLevel(_g->numlines * sizeof(lineopening_t), NULL);
+#endif
+
     for (i=0; i<_g->numlines; i++)
     {
         _g->linedata[i].special = _g->lines[i].const_special;
+
+#if defined OPENING_CACHE
+        // No sector has moved yet, so this forces the first computation.
+        _g->lineopenings[i].generation = UINT32_MAX;
+#endif
     }
 }
 
@@ -407,6 +413,42 @@ static void P_LoadBlockMap (int16_t lump)
     _g->blocklinks = Z_CallocLevel(_g->bmapwidth * _g->bmapheight * sizeof(*_g->blocklinks));
 
     _g->blockmap = _g->blockmaplump+4;
+
+#if defined COMPACT_BLOCKMAP
+    int32_t numblocks = _g->bmapwidth * _g->bmapheight;
+    int32_t numblocklines = 0;
+
+    // Every list starts with a 0 delimiter and ends with -1
+    for (int32_t i = 0; i < numblocks; i++)
+    {
+        const int16_t* list = _g->blockmaplump + _g->blockmap[i] + 1;
+
+        while (*list++ != -1)
+            numblocklines++;
+    }
+
+    _g->blockstart = Z_MallocLevel((numblocks + 1) * sizeof(*_g->blockstart), NULL);
+    _g->blocklines = Z_MallocLevel(numblocklines * sizeof(*_g->blocklines), NULL);
+
+    numblocklines = 0;
+
+    for (int32_t i = 0; i < numblocks; i++)
+    {
+        const int16_t* list = _g->blockmaplump + _g->blockmap[i] + 1;
+
+        _g->blockstart[i] = numblocklines;
+
+        for ( ; *list != -1; list++)
+            _g->blocklines[numblocklines++] = *list;
+    }
+
+    _g->blockstart[numblocks] = numblocklines;
+
+    _g->lineboxes = Z_MallocLevel(_g->numlines * sizeof(*_g->lineboxes), NULL);
+
+    for (int32_t i = 0; i < _g->numlines; i++)
+        memcpy(_g->lineboxes[i].bbox, _g->lines[i].bbox, sizeof(_g->lineboxes[i].bbox));
+#endif
 }
 
 //
@@ -416,6 +458,7 @@ static void P_LoadBlockMap (int16_t lump)
 static void P_LoadReject(int16_t lump)
 {
   _g->rejectmatrix = W_GetLumpByNumAutoFree(lump);
+  _g->rejectvalid  = W_LumpLength(lump) >= ((int32_t)_g->numsectors * _g->numsectors + 7) / 8;
 }
 
 //
@@ -531,6 +574,7 @@ static void R_ResetPlanes()
     memset(_g->visplanes, 0, sizeof(_g->visplanes));
     _g->freetail = NULL;
     _g->freehead = &_g->freetail;
+    _g->numvisplanes = 0;
 }
 
 
@@ -539,6 +583,10 @@ static void P_FreeLevelData()
     R_ResetPlanes();
 
     Z_FreeTags();
+
+    // the peaks are per level
+    Z_ResetStats();
+    R_ResetRenderStats();
 }
 
 //
@@ -566,6 +614,8 @@ void P_SetupLevel(int32_t map)
 
     P_FreeLevelData();
 
+    R_DirtyWorld();
+
     //Load the sky texture.
     R_GetTexture(_g->skytexture);
 
@@ -622,4 +672,8 @@ void P_Init (void)
     P_InitSwitchList();
     P_InitPicAnims();
     R_InitSprites();
+
+#if !defined _M_I86
+    P_CheckBrainlessStates();
+#endif
 }
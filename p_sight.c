@@ -194,6 +194,20 @@ static boolean P_CrossBSPNode(int32_t bspnum)
 }
 
 
+//
+// P_RejectBlocks
+// Returns true if REJECT says that nothing
+//  in sector s1 can see sector s2.
+//
+
+boolean P_RejectBlocks(const sector_t *s1, const sector_t *s2)
+{
+  int32_t pnum = (s1-_g->sectors)*_g->numsectors + (s2-_g->sectors);
+
+  return _g->rejectmatrix[pnum>>3] & (1 << (pnum&7));
+}
+
+
 //
 // P_CheckSight
 // Returns true
@@ -1015,6 +1015,9 @@ void P_CrossSpecialLine(const line_t *line, int32_t side, mobj_t *thing)
 {
   int32_t         ok;
 
+  // Line specials change lights, textures and sectors all over the level
+  R_DirtyWorld();
+
   //  Things that should never trigger lines
   if (!P_MobjIsPlayer(thing))
   {
@@ -1897,6 +1900,8 @@ void P_ShootSpecialLine
     // line special is gun triggered generalized linedef type
     int32_t (*linefunc)(const line_t *line)=NULL;
 
+    R_DirtyWorld();
+
     // check each range of generalized linedefs
     if ((uint32_t)LN_SPECIAL(line) >= GenEnd)
     {
@@ -2193,6 +2198,9 @@ void P_UpdateSpecials (void)
     int32_t         i;
 
     // Animate flats and textures globally
+    if (_g->anims != _g->lastanim && !(_g->leveltime & 7))
+        R_DirtyWorld();
+
     for (anim = _g->anims ; anim < _g->lastanim ; anim++)
     {
         uint32_t t = (_g->leveltime >> 3);
@@ -2241,6 +2249,7 @@ void P_UpdateSpecials (void)
 
                 S_StartSound2(_g->buttonlist[i].soundorg, sfx_swtchn);
                 memset(&_g->buttonlist[i],0,sizeof(button_t));
+                R_DirtyWorld();
             }
         }
     }
@@ -2372,6 +2381,7 @@ static void T_Scroll(scroll_t *s)
 {
     side_t *side  =_g->sides + s->affectee;
     side->textureoffset++;
+    R_DirtySector(side->sector);
 }
 
 //
@@ -2397,7 +2407,7 @@ static void Add_Scroller(int32_t affectee)
   scroll_t *s = Z_CallocLevSpec(sizeof *s);
   s->thinker.function = T_Scroll;
   s->affectee = affectee;
-  P_AddThinker(&s->thinker);
+  P_AddThinkerToClass(&s->thinker, th_scroller);
 }
 
 // Initialize the scrollers
@@ -577,6 +577,7 @@ typedef struct
   int32_t maxlight;
   int32_t darktime;
   int32_t brighttime;
+  int32_t parkedtic;   // leveltime of the first tic missed while parked
 
 } strobe_t;
 
@@ -587,6 +588,7 @@ typedef struct
   int32_t minlight;
   int32_t maxlight;
   int32_t direction;
+  int32_t parkedtic;   // leveltime of the first tic missed while parked
 
 } glow_t;
 
@@ -967,6 +969,8 @@ int32_t EV_LightTurnOn
 
 int32_t EV_LightTurnOnPartway(const line_t* line, fixed_t level); // killough 10/10/98
 
+void P_WakeParkedLights(const sector_t *sec);
+
 // p_floor
 
 int32_t EV_DoChange
@@ -237,6 +237,7 @@ P_UseSpecialLine
   const line_t*       line,
   int32_t           side )
 {
+  R_DirtyWorld();
 
   // e6y
   // b.m. side test was broken in boom201
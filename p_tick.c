@@ -58,20 +58,48 @@
 
 void P_InitThinkers(void)
 {
-  _g->thinkerclasscap.prev = _g->thinkerclasscap.next  = &_g->thinkerclasscap;
+  for (int16_t i = 0; i < NUMTHCLASS; i++)
+    _g->thinkerclasscap[i].prev = _g->thinkerclasscap[i].next  = &_g->thinkerclasscap[i];
+}
+
+//
+// P_AddThinkerToClass
+// Adds a new thinker at the end of the list of its class.
+//
+
+void P_AddThinkerToClass(thinker_t* thinker, th_class cls)
+{
+  thinker_t* cap = &_g->thinkerclasscap[cls];
+
+  cap->prev->next = thinker;
+  thinker->next = cap;
+  thinker->prev = cap->prev;
+  cap->prev = thinker;
 }
 
 //
 // P_AddThinker
-// Adds a new thinker at the end of the list.
+// Adds a new thinker at the end of the main list.
 //
 
 void P_AddThinker(thinker_t* thinker)
 {
-  _g->thinkerclasscap.prev->next = thinker;
-  thinker->next = &_g->thinkerclasscap;
-  thinker->prev = _g->thinkerclasscap.prev;
-  _g->thinkerclasscap.prev = thinker;
+  P_AddThinkerToClass(thinker, th_main);
+}
+
+//
+// P_ChangeThinkerClass
+// Moves a thinker to the end of another list.
+// Safe for the thinker that is running, P_RunThinkers
+// has already loaded its successor.
+//
+
+void P_ChangeThinkerClass(thinker_t* thinker, th_class cls)
+{
+  thinker_t *next = thinker->next;
+  (next->prev = thinker->prev)->next = next;
+
+  P_AddThinkerToClass(thinker, cls);
 }
 
 //
@@ -115,12 +143,7 @@ static void P_RemoveThingDelayed(thinker_t *thinker)
          * thinker->prev->next = thinker->next */
     (next->prev = thinker->prev)->next = next;
 
-    mobj_t* thing = (mobj_t*)thinker;
-
-    if(thing->flags & MF_POOLED)
-        thing->type = MT_NOTHING;
-    else
-        Z_Free(thinker);
+    P_FreeMobj((mobj_t*)thinker);
 }
 
 //
@@ -143,6 +166,10 @@ void P_RemoveThinker(thinker_t *thinker)
 
 void P_RemoveThing(mobj_t *thing)
 {
+  // Inert things never get their turn
+  if (!thing->thinker.function)
+    P_ChangeThinkerClass(&thing->thinker, th_brainless);
+
   thing->thinker.function = P_RemoveThingDelayed;
 }
 
@@ -152,7 +179,7 @@ void P_RemoveThing(mobj_t *thing)
  */
 thinker_t* P_NextThinker(thinker_t* th)
 {
-  thinker_t* top = &_g->thinkerclasscap;
+  thinker_t* top = &_g->thinkerclasscap[th_main];
   if (!th) th = top;
   th = th->next;
   return th == top ? NULL : th;
@@ -199,10 +226,10 @@ void P_SetTarget(mobj_t **mop, mobj_t *targ)
 // external and using P_RemoveThinkerDelayed() implicitly.
 //
 
-static void P_RunThinkers (void)
+static void P_RunThinkerClass (th_class cls)
 {
-    thinker_t* th = _g->thinkerclasscap.next;
-    thinker_t* th_end = &_g->thinkerclasscap;
+    thinker_t* th = _g->thinkerclasscap[cls].next;
+    thinker_t* th_end = &_g->thinkerclasscap[cls];
 
     while(th != th_end)
     {
@@ -214,6 +241,12 @@ static void P_RunThinkers (void)
     }
 }
 
+static void P_RunThinkers (void)
+{
+    for (int16_t cls = th_main; cls < th_inert; cls++)
+        P_RunThinkerClass(cls);
+}
+
 
 void P_Ticker (void)
 {
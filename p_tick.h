@@ -43,8 +43,26 @@
 
 void P_Ticker(void);
 
+/* Thinkers that use P_Random or touch the things of other thinkers
+ * have to run in the order they were spawned to keep demos in sync,
+ * they stay in th_main. The other classes only change what is drawn
+ * and run after it. th_inert and th_parked are never run. */
+
+typedef enum
+{
+  th_main,       // active mobjs, movers and randomly flickering lights
+  th_brainless,  // mobjs that only cycle through their states
+  th_lighting,   // glowing and strobing lights
+  th_scroller,   // scrolling walls
+  th_inert,      // mobjs with tics == -1
+  th_parked,     // lights the player can't see, see P_WakeParkedLights
+  NUMTHCLASS
+} th_class;
+
 void P_InitThinkers(void);
 void P_AddThinker(thinker_t *thinker);
+void P_AddThinkerToClass(thinker_t *thinker, th_class cls);
+void P_ChangeThinkerClass(thinker_t *thinker, th_class cls);
 void P_RemoveThinker(thinker_t *thinker);
 void P_RemoveThing(mobj_t *thing);
 
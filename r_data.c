@@ -35,6 +35,7 @@
  *-----------------------------------------------------------------------------*/
 
 #include "doomstat.h"
+#include "compiler.h"
 #include "w_wad.h"
 #include "r_main.h"
 #include "m_fixed.h"
@@ -86,89 +87,22 @@ typedef PACKEDATTR_PRE struct
 // A maptexture_t describes a rectangular texture, which is composed
 // of one or more mappatch_t structures that arrange graphic patches.
 
-static const texture_t **textures;
-
-static void R_LoadTexture(int16_t texture_num)
-{
-    const byte    *pnames = W_GetLumpByName("PNAMES");
-    const int32_t *maptex = W_GetLumpByName("TEXTURE1");
-    const int32_t *directory = maptex+1;
-
-    const maptexture_t *mtexture = (const maptexture_t *) ((const byte *)maptex + directory[texture_num]);
-
-    texture_t* texture = Z_MallocLevel(sizeof(const texture_t) + sizeof(const texpatch_t)*(mtexture->patchcount-1), (void**)&textures[texture_num]);
-
-    texture->width      = mtexture->width;
-    texture->height     = mtexture->height;
-    texture->patchcount = mtexture->patchcount;
-    //texture->name       = mtexture->name;
-    int16_t w = 1;
-    while (w * 2 <= texture->width)
-        w <<= 1;
-    texture->widthmask  = w - 1;
-
-
-    texpatch_t* patch = texture->patches;
-    const mappatch_t* mpatch = mtexture->patches;
+// TEXTURE1 and PNAMES are parsed once at startup into a table of
+// texture_t records with resolved patch lump numbers and overlap flags,
+// so loading a level doesn't touch those lumps anymore.
 
-    texture->overlapped = false;
+// Build option: keep the texture table in a file,
+// so the next startup doesn't have to build it.
+//#define TEXTURE_TABLE_FILE "TEXTURES.LMP"
 
-    //Skip to list of names.
-    pnames += 4;
-
-    for (uint8_t j = 0; j < texture->patchcount; j++, mpatch++, patch++)
-    {
-        patch->originx = mpatch->originx;
-        patch->originy = mpatch->originy;
-
-        char pname[8];
-        strncpy(pname, (const char*)&pnames[mpatch->patch * 8], 8);
-
-        patch->patch_num = W_GetNumForName(pname);
-    }
-
-    pnames -= 4;
-    Z_Free(pnames);
-    Z_Free(maptex);
-
-    for (uint8_t j = 0; j < texture->patchcount; j++)
-    {
-        const texpatch_t* patch = &texture->patches[j];
-
-        //Check for patch overlaps.
-        int16_t l1 = patch->originx;
-        int16_t r1 = l1 + V_NumPatchWidth(patch->patch_num);
-
-        for (uint8_t k = j + 1; k < texture->patchcount; k++)
-        {
-            if (k == j)
-                continue;
-
-            const texpatch_t* p2 = &texture->patches[k];
-
-            //Check for patch overlaps.
-            int16_t l2 = p2->originx;
-            int16_t r2 = l2 + V_NumPatchWidth(p2->patch_num);
-
-            if (r1 > l2 && l1 < r2)
-            {
-                texture->overlapped = true;
-                break;
-            }
-        }
-
-        if (texture->overlapped)
-            break;
-    }
-
-    textureheight[texture_num] = ((int32_t)texture->height) << FRACBITS;
-
-    texturetranslation[texture_num] = texture_num;
+static int16_t numtextures;
+static const texture_t **textures;
+static const char (*texturenames)[8];
 
-    textures[texture_num] = texture;
-}
+// The records of all textures, back to back
+static byte    *texturetable;
+static uint16_t texturetablesize;
 
-static int16_t numtextures;
 
 const texture_t* R_GetTexture(int16_t texture)
 {
@@ -177,10 +111,13 @@ const texture_t* R_GetTexture(int16_t texture)
         I_Error("R_GetTexture: Texture %d not in range.", texture);
 #endif
 texture = 2; //FIXME not everything has to be a door
-    if (!textures[texture])
-        R_LoadTexture(texture);
+    const texture_t* tex = textures[texture];
 
-    return textures[texture];
+    // only textures that are used have a height
+    if (!textureheight[texture])
+        textureheight[texture] = ((int32_t)tex->height) << FRACBITS;
+
+    return tex;
 }
 
 static int16_t R_GetTextureNumForName(const char* tex_name)
@@ -193,20 +130,10 @@ static int16_t R_GetTextureNumForName(const char* tex_name)
 
     strupr(tex_name_upper);
 
-    const int32_t *maptex = W_GetLumpByName("TEXTURE1");
-    const int32_t *directory = maptex+1;
-
     for (int16_t i = 0; i < numtextures; i++)
     {
-        int32_t offset = *directory++;
-
-        const maptexture_t* mtexture = (const maptexture_t *) ( (const byte *)maptex + offset);
-
-        if (!strncmp(tex_name_upper, mtexture->name, 8))
-        {
-            Z_Free(maptex);
+        if (!strncmp(tex_name_upper, texturenames[i], 8))
             return i;
-        }
     }
 
     I_Error("R_GetTextureNumForName: texture name: %s not found.", tex_name);
@@ -240,6 +167,206 @@ int16_t PUREFUNC R_CheckTextureNumForName (const char *tex_name)
 }
 
 
+static boolean R_TextureOverlapped(const texture_t* texture, const int16_t* widths)
+{
+    for (uint8_t j = 0; j < texture->patchcount; j++)
+    {
+        //Check for patch overlaps.
+        int16_t l1 = texture->patches[j].originx;
+        int16_t r1 = l1 + widths[j];
+
+        for (uint8_t k = j + 1; k < texture->patchcount; k++)
+        {
+            int16_t l2 = texture->patches[k].originx;
+            int16_t r2 = l2 + widths[k];
+
+            if (r1 > l2 && l1 < r2)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+//
+// R_TextureTableSize
+// The size of the records of all textures in TEXTURE1.
+//
+
+static int32_t R_TextureTableSize(const int32_t* maptex)
+{
+    const int32_t *directory = maptex+1;
+
+    int32_t size = 0;
+    for (int16_t i = 0; i < numtextures; i++)
+    {
+        const maptexture_t *mtexture = (const maptexture_t *) ((const byte *)maptex + directory[i]);
+        size += sizeof(texture_t) + sizeof(texpatch_t)*(mtexture->patchcount-1);
+    }
+
+    return size;
+}
+
+
+//
+// R_BuildTextureTable
+// Parses TEXTURE1 and PNAMES into names[] and texturetable,
+// offsets[i] is where the record of texture i starts.
+//
+
+static void R_BuildTextureTable(char (*names)[8], uint16_t* offsets)
+{
+    const int32_t *maptex = W_GetLumpByName("TEXTURE1");
+    const int32_t *directory = maptex+1;
+
+    // resolve the patch names once,
+    // names that aren't in the WAD are only an error when a texture uses them
+    const byte *pnames = W_GetLumpByName("PNAMES");
+    int32_t nummappatches = *(const int32_t*)pnames;
+    int16_t *patchlookup = Z_MallocStatic(nummappatches * sizeof(int16_t));
+
+    for (int32_t i = 0; i < nummappatches; i++)
+    {
+        char pname[8];
+        strncpy(pname, (const char*)&pnames[4 + i * 8], 8);
+        patchlookup[i] = W_CheckNumForName(pname);
+    }
+
+    Z_Free(pnames);
+
+    int32_t size = R_TextureTableSize(maptex);
+
+    if (size > 0xffff)
+        I_Error("R_BuildTextureTable: texture table too big");
+
+    texturetablesize = size;
+    texturetable = Z_MallocStatic(texturetablesize);
+
+    uint16_t offset = 0;
+    for (int16_t i = 0; i < numtextures; i++)
+    {
+        const maptexture_t *mtexture = (const maptexture_t *) ((const byte *)maptex + directory[i]);
+        texture_t* texture = (texture_t*)&texturetable[offset];
+
+        memcpy(names[i], mtexture->name, 8);
+        offsets[i] = offset;
+
+        texture->width      = mtexture->width;
+        texture->height     = mtexture->height;
+        texture->patchcount = mtexture->patchcount;
+        int16_t w = 1;
+        while (w * 2 <= texture->width)
+            w <<= 1;
+        texture->widthmask  = w - 1;
+
+        texpatch_t* patch = texture->patches;
+        const mappatch_t* mpatch = mtexture->patches;
+        int16_t widths[256];
+
+        for (uint8_t j = 0; j < texture->patchcount; j++, mpatch++, patch++)
+        {
+            patch->originx   = mpatch->originx;
+            patch->originy   = mpatch->originy;
+            patch->patch_num = patchlookup[mpatch->patch];
+
+            if (patch->patch_num == -1)
+                I_Error("R_BuildTextureTable: Missing patch in texture %.8s", mtexture->name);
+
+            widths[j]        = V_NumPatchWidth(patch->patch_num);
+        }
+
+        texture->overlapped = R_TextureOverlapped(texture, widths);
+
+        offset += sizeof(texture_t) + sizeof(texpatch_t)*(texture->patchcount-1);
+    }
+
+    Z_Free(patchlookup);
+    Z_Free(maptex);
+}
+
+
+#if defined TEXTURE_TABLE_FILE
+typedef struct
+{
+    int16_t  numtextures;
+    uint16_t texturetablesize;
+    int32_t  texture1size;      // to notice a different WAD
+    int32_t  pnamessize;
+    uint16_t texturesize;       // to notice a different compiler
+} texturetableheader_t;
+
+
+static void R_FillTextureTableHeader(texturetableheader_t* header)
+{
+    const int32_t *maptex = W_GetLumpByName("TEXTURE1");
+
+    memset(header, 0, sizeof(*header));
+    header->numtextures      = numtextures;
+    header->texturetablesize = R_TextureTableSize(maptex);
+    header->texture1size     = W_LumpLength(W_GetNumForName("TEXTURE1"));
+    header->pnamessize       = W_LumpLength(W_GetNumForName("PNAMES"));
+    header->texturesize      = sizeof(texture_t);
+
+    Z_Free(maptex);
+}
+
+
+static boolean R_ReadTextureTable(char (*names)[8], uint16_t* offsets)
+{
+    FILE* fp = fopen(TEXTURE_TABLE_FILE, "rb");
+    if (fp == NULL)
+        return false;
+
+    texturetableheader_t header, expected;
+    boolean ok = fread(&header, sizeof(header), 1, fp) == 1;
+
+    // The size in the header is only trusted
+    // if it matches the size computed from TEXTURE1.
+    if (ok)
+    {
+        R_FillTextureTableHeader(&expected);
+        ok = !memcmp(&header, &expected, sizeof(header));
+    }
+
+    if (ok)
+    {
+        texturetablesize = header.texturetablesize;
+        texturetable = Z_MallocStatic(texturetablesize);
+        ok = fread(names, 8, numtextures, fp) == numtextures
+          && fread(offsets, sizeof(uint16_t), numtextures, fp) == numtextures
+          && fread(texturetable, texturetablesize, 1, fp) == 1;
+
+        if (!ok)
+        {
+            Z_Free(texturetable);
+            texturetable = NULL;
+        }
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+
+static void R_WriteTextureTable(const char (*names)[8], const uint16_t* offsets)
+{
+    FILE* fp = fopen(TEXTURE_TABLE_FILE, "wb");
+    if (fp == NULL)
+        return;
+
+    texturetableheader_t header;
+    R_FillTextureTableHeader(&header);
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(names, 8, numtextures, fp);
+    fwrite(offsets, sizeof(uint16_t), numtextures, fp);
+    fwrite(texturetable, texturetablesize, 1, fp);
+    fclose(fp);
+}
+#endif
+
+
 //
 // R_InitTextures
 // Initializes the texture list
@@ -252,8 +379,26 @@ static void R_InitTextures()
 	numtextures = *mtex1;
 	Z_Free(mtex1);
 
+	char (*names)[8] = Z_MallocStatic(numtextures * 8);
+	uint16_t* offsets = Z_MallocStatic(numtextures * sizeof(uint16_t));
+
+#if defined TEXTURE_TABLE_FILE
+	if (!R_ReadTextureTable(names, offsets))
+	{
+		R_BuildTextureTable(names, offsets);
+		R_WriteTextureTable((const char (*)[8])names, offsets);
+	}
+#else
+	R_BuildTextureTable(names, offsets);
+#endif
+
+	texturenames = (const char (*)[8])names;
+
 	textures = Z_MallocStatic(numtextures*sizeof*textures);
-	memset(textures, 0, numtextures*sizeof*textures);
+	for (int16_t i = 0; i < numtextures; i++)
+		textures[i] = (const texture_t*)&texturetable[offsets[i]];
+
+	Z_Free(offsets);
 
 	textureheight = Z_MallocStatic(numtextures*sizeof*textureheight);
 	memset(textureheight, 0, numtextures*sizeof*textureheight);
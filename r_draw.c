@@ -55,11 +55,11 @@
 #include "st_stuff.h"
 #include "i_system.h"
 #include "g_game.h"
-#include "m_random.h"
 
 #include "globdata.h"
 
 
+
 #if 0
 static const int8_t viewangletoxTable[4096];
 static const angle_t _huge tantoangleTable[2049];
@@ -85,32 +85,36 @@ static fixed_t finetangent(int16_t x)
 #else
 static int8_t viewangletox(int16_t viewangle)
 {
+	if (_g->tableViewAngleToX)
+		return _g->tableViewAngleToX[viewangle];
+
 	int8_t x;
-	fseek(_g->fileViewAngleToX, viewangle * sizeof(int8_t), SEEK_SET);
-	fread(&x, sizeof(int8_t), 1, _g->fileViewAngleToX);
+	R_ReadLookupTable(_g->fileViewAngleToX, viewangle * sizeof(int8_t), &x, sizeof(int8_t));
 	return x;
 }
 
 static angle_t tantoangle(int16_t tan)
 {
+	if (_g->tableTanToAngle)
+		return _g->tableTanToAngle[tan];
+
 	angle_t angle;
-	fseek(_g->fileTanToAngle, tan * sizeof(angle_t), SEEK_SET);
-	fread(&angle, sizeof(angle_t), 1, _g->fileTanToAngle);
+	R_ReadLookupTable(_g->fileTanToAngle, tan * sizeof(angle_t), &angle, sizeof(angle_t));
 	return angle;
 }
 
 static fixed_t finetangent(int16_t x)
 {
+	if (_g->tableFineTan)
+		return _g->tableFineTan[x];
+
 	fixed_t f;
-	fseek(_g->fileFineTan, x * sizeof(fixed_t), SEEK_SET);
-	fread(&f, sizeof(fixed_t), 1, _g->fileFineTan);
+	R_ReadLookupTable(_g->fileFineTan, x * sizeof(fixed_t), &f, sizeof(fixed_t));
 	return f;
 }
 #endif
 
 
-static uint32_t columnCacheEntries[128];
-
 int16_t floorclip[SCREENWIDTH];
 int16_t ceilingclip[SCREENWIDTH];
 
@@ -150,9 +154,65 @@ static int16_t negonearray[SCREENWIDTH] =
 //*****************************************
 //Column cache stuff.
 //GBA has 16kb of Video Memory for columns
+//The size and associativity are set with
+//-colcache <entries> and -colways <ways>.
 //*****************************************
 
-static byte columnCache[128*128];
+#define COLUMN_CACHE_ENTRIES 128
+#define COLUMN_CACHE_WAYS 4
+
+// The columns of a cache have to fit in one 64 kB segment on 16-bit.
+#if defined _M_I86
+#define COLUMN_CACHE_MAX_ENTRIES 256
+#else
+#define COLUMN_CACHE_MAX_ENTRIES 4096
+#endif
+
+typedef struct
+{
+    uint32_t* entries;  // CACHE_ENTRY of each column, 0 = unused
+    uint16_t* stamps;   // time of the last use, for LRU replacement
+    byte*     columns;  // 128 bytes per entry
+    uint16_t  clock;
+
+    uint32_t  hits;
+    uint32_t  misses;
+} columncache_t;
+
+static columncache_t columnCache;
+
+
+// Build option: keep a second cache of wall columns
+// that are already translated through the colormap,
+// so walls draw with one lookup per pixel.
+// Costs another 16kb, so not on 16-bit targets.
+#if !defined _M_I86
+#define PRELIT_COLUMNS
+#endif
+
+#if defined PRELIT_COLUMNS
+static columncache_t prelitCache;
+#endif
+
+// Build option: draw walls into a scratch tile of 4 or 8 columns
+// and copy the tile to the screen a row at a time,
+// instead of striding down the screen for every pixel.
+//#define WALL_TILE_COLUMNS 4
+
+#if defined WALL_TILE_COLUMNS
+#if WALL_TILE_COLUMNS != 4 && WALL_TILE_COLUMNS != 8
+#error WALL_TILE_COLUMNS must be 4 or 8
+#endif
+
+static byte    walltile[WALL_TILE_COLUMNS][SCREENHEIGHT];  // column-major
+static uint8_t walltilemask[SCREENHEIGHT];                 // columns drawn per row
+static int16_t walltilex;
+static int16_t walltileyl = SCREENHEIGHT;
+static int16_t walltileyh = -1;
+#endif
+
+static uint16_t cacheEntries;
+static uint16_t cacheStride;    // cacheEntries / ways
 
 
 //*****************************************
@@ -221,6 +281,10 @@ static angle_t  rw_centerangle;
 static fixed_t  rw_offset;
 static int32_t      rw_lightlevel;
 
+#if defined PRELIT_COLUMNS
+static int16_t      rw_colormapnum;
+#endif
+
 static int16_t      *maskedtexturecol; // dropoff overflow
 
 fixed_t   *textureheight; //needed for texture pegging (and TFE fix - killough)
@@ -652,6 +716,176 @@ void R_DrawColumn (const draw_column_vars_t *dcvars)
     }
 }
 
+typedef void (*R_DrawColumn_f)(const draw_column_vars_t *dcvars);
+
+
+#if defined PRELIT_COLUMNS
+inline static void R_DrawPrelitColumnPixel(uint16_t* dest, const byte* source, uint32_t frac)
+{
+	uint16_t color = source[frac>>COLBITS];
+
+	*dest = (color | (color << 8));
+}
+
+
+//
+// R_DrawPrelitColumn
+// Same as R_DrawColumn, but the source
+//  has already been translated through the colormap.
+//
+static void R_DrawPrelitColumn(const draw_column_vars_t *dcvars)
+{
+    int32_t count = (dcvars->yh - dcvars->yl) + 1;
+
+    // Zero length, column does not exceed a pixel.
+    if (count <= 0)
+        return;
+
+    const byte *source = dcvars->source;
+
+    uint16_t* dest = _g->screen + ScreenYToOffset(dcvars->yl) + dcvars->x;
+
+    const uint32_t		fracstep = (dcvars->iscale << COLEXTRABITS);
+    uint32_t frac = (dcvars->texturemid + (dcvars->yl - centery)*dcvars->iscale) << COLEXTRABITS;
+
+    uint32_t l = (count >> 3);
+
+    while(l--)
+    {
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+    }
+
+    uint32_t r = (count & 7);
+
+    switch(r)
+    {
+        case 7:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 6:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 5:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 4:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 3:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 2:     R_DrawPrelitColumnPixel(dest, source, frac); dest+=SCREENWIDTH; frac+=fracstep;
+        case 1:     R_DrawPrelitColumnPixel(dest, source, frac);
+    }
+}
+#endif
+
+
+#if defined WALL_TILE_COLUMNS
+//
+// R_FlushWallTile
+// Transposes the tile onto the screen.
+// Rows that every column of the tile has drawn to
+//  are copied with one store.
+//
+static void R_FlushWallTile(void)
+{
+    if (walltileyh < walltileyl)
+        return;
+
+    uint16_t* dest = _g->screen + ScreenYToOffset(walltileyl) + walltilex;
+
+    for (int16_t y = walltileyl; y <= walltileyh; y++)
+    {
+        uint8_t mask = walltilemask[y];
+
+        if (mask == (1 << WALL_TILE_COLUMNS) - 1)
+        {
+            uint16_t row[WALL_TILE_COLUMNS];
+
+            for (int16_t c = 0; c < WALL_TILE_COLUMNS; c++)
+                row[c] = walltile[c][y] * 0x0101;
+
+            memcpy(dest, row, sizeof(row));
+        }
+        else
+        {
+            for (int16_t c = 0; mask; c++, mask >>= 1)
+            {
+                if (mask & 1)
+                    dest[c] = walltile[c][y] * 0x0101;
+            }
+        }
+
+        walltilemask[y] = 0;
+        dest += SCREENWIDTH;
+    }
+
+    walltileyl = SCREENHEIGHT;
+    walltileyh = -1;
+}
+
+
+//
+// R_DrawTileColumn
+// Draws a wall column into the tile.
+// The tile is flushed when the column falls outside of it.
+//
+static void R_DrawTileColumn(const draw_column_vars_t *dcvars)
+{
+    int16_t yl = dcvars->yl;
+    int16_t yh = dcvars->yh;
+
+    // Zero length, column does not exceed a pixel.
+    if (yh < yl)
+        return;
+
+    int16_t c = dcvars->x - walltilex;
+
+    if (c < 0 || c >= WALL_TILE_COLUMNS)
+    {
+        R_FlushWallTile();
+        walltilex = dcvars->x;
+        c = 0;
+    }
+
+    if (yl < walltileyl)
+        walltileyl = yl;
+
+    if (yh > walltileyh)
+        walltileyh = yh;
+
+    const byte *source = dcvars->source;
+#if !defined PRELIT_COLUMNS
+    const byte *colormap = dcvars->colormap;
+#endif
+
+    byte* dest = &walltile[c][yl];
+    uint8_t* mask = &walltilemask[yl];
+    const uint8_t bit = 1 << c;
+
+    const uint32_t		fracstep = (dcvars->iscale << COLEXTRABITS);
+    uint32_t frac = (dcvars->texturemid + (yl - centery)*dcvars->iscale) << COLEXTRABITS;
+
+    int16_t count = (yh - yl) + 1;
+
+    do
+    {
+#if defined PRELIT_COLUMNS
+        *dest++ = source[frac>>COLBITS];
+#else
+        *dest++ = colormap[source[frac>>COLBITS]];
+#endif
+        *mask++ |= bit;
+        frac += fracstep;
+    } while (--count);
+}
+
+#define R_DrawWallColumn R_DrawTileColumn
+#elif defined PRELIT_COLUMNS
+#define R_DrawWallColumn R_DrawPrelitColumn
+#else
+#define R_DrawWallColumn R_DrawColumn
+#endif
+
 static void R_DrawColumnHiRes(const draw_column_vars_t *dcvars)
 {
     int32_t count = (dcvars->yh - dcvars->yl) + 1;
@@ -768,7 +1002,6 @@ static void R_DrawFuzzColumn (const draw_column_vars_t *dcvars)
 //  in posts/runs of opaque pixels.
 //
 
-typedef void (*R_DrawColumn_f)(const draw_column_vars_t *dcvars);
 
 static void R_DrawMaskedColumn(R_DrawColumn_f colfunc, draw_column_vars_t *dcvars, const column_t *column)
 {
@@ -832,6 +1065,9 @@ static void R_SetDefaultDrawColumnVars(draw_column_vars_t *dcvars)
 //  mfloorclip and mceilingclip should also be set.
 //
 // CPhipps - new wad lump handling, *'s to const*'s
+// The fuzz changes every frame, so a frame with shadows can't be reused.
+static boolean fuzzdrawn;
+
 static void R_DrawVisSprite(const vissprite_t *vis)
 {
     fixed_t  frac;
@@ -848,7 +1084,10 @@ static void R_DrawVisSprite(const vissprite_t *vis)
     // mixed with translucent/non-translucenct 2s normals
 
     if (!dcvars.colormap)   // NULL colormap = shadow draw
+    {
         colfunc = R_DrawFuzzColumn;    // killough 3/14/98
+        fuzzdrawn = true;
+    }
     else
     {
         hires = highDetail;
@@ -866,7 +1105,8 @@ static void R_DrawVisSprite(const vissprite_t *vis)
     sprtopscreen = centeryfrac - FixedMul(dcvars.texturemid, spryscale);
 
 
-    const patch_t *patch = W_GetLumpByNum(vis->patch_num);
+    const patch_t *patch = W_GetPatchHeader(vis->patch_num);
+    const int16_t patchwidth = patch->width;
 
     fixed_t xiscale = vis->xiscale;
 
@@ -878,12 +1118,12 @@ static void R_DrawVisSprite(const vissprite_t *vis)
 
     while(dcvars.x < SCREENWIDTH)
     {
-        const column_t* column = (const column_t *) ((const byte *)patch + patch->columnofs[frac >> FRACBITS]);
+        const column_t* column = W_GetPatchColumn(vis->patch_num, frac >> FRACBITS);
         R_DrawMaskedColumn(colfunc, &dcvars, column);
 
         frac += xiscale;
 
-        if(((frac >> FRACBITS) >= patch->width) || frac < 0)
+        if(((frac >> FRACBITS) >= patchwidth) || frac < 0)
             break;
 
         dcvars.odd_pixel = true;
@@ -894,19 +1134,17 @@ static void R_DrawVisSprite(const vissprite_t *vis)
         if(dcvars.x >= SCREENWIDTH)
             break;
 
-        const column_t* column2 = (const column_t *) ((const byte *)patch + patch->columnofs[frac >> FRACBITS]);
+        const column_t* column2 = W_GetPatchColumn(vis->patch_num, frac >> FRACBITS);
         R_DrawMaskedColumn(colfunc, &dcvars, column2);
 
         frac += xiscale;
 
-        if(((frac >> FRACBITS) >= patch->width) || frac < 0)
+        if(((frac >> FRACBITS) >= patchwidth) || frac < 0)
             break;
 
         dcvars.x++;
         dcvars.odd_pixel = false;
     }
-
-    Z_Free(patch);
 }
 
 
@@ -1014,12 +1252,9 @@ static void R_RenderMaskedSegRange(const drawseg_t *ds, int32_t x1, int32_t x2)
 
             // draw the texture
             uint32_t r = R_GetColumn(texture, xc);
-            const patch_t* patch = W_GetLumpByNum(HIWORD(r));
-            xc = LOWORD(r);
-            const column_t* column = (const column_t *) ((const byte *)patch + patch->columnofs[xc]);
+            const column_t* column = W_GetPatchColumn(HIWORD(r), LOWORD(r));
 
             R_DrawMaskedColumn(R_DrawColumn, &dcvars, column);
-            Z_Free(patch);
             maskedtexturecol[dcvars.x] = SHRT_MAX; // dropoff overflow
         }
     }
@@ -1055,82 +1290,153 @@ static PUREFUNC int32_t R_PointOnSegSide(fixed_t x, fixed_t y, const seg_t *line
 
 
 //
-// R_DrawSprite
+// Drawseg bins.
+// After the BSP walk, every bin of screen columns gets a bitmask
+//  of the drawsegs that may clip sprites in those columns,
+//  so a sprite only visits drawsegs that overlap it.
 //
 
-static void R_DrawSprite (const vissprite_t* spr)
+#define DRAWSEG_BIN_SHIFT 3
+#define DRAWSEG_BINS ((SCREENWIDTH + (1 << DRAWSEG_BIN_SHIFT) - 1) >> DRAWSEG_BIN_SHIFT)
+#define DRAWSEG_WORDS ((MAXDRAWSEGS + 15) / 16)
+
+static uint16_t drawsegbins[DRAWSEG_BINS][DRAWSEG_WORDS];
+
+static uint32_t drawsegchecks;      // drawsegs visited by sprites since R_ResetRenderStats
+static uint32_t pvsculled;          // nodes and subsectors outside the PVS since R_ResetRenderStats
+#if defined REUSE_FRAMES
+static uint32_t reusedframes;       // frames copied from the last view since R_ResetRenderStats
+#endif
+
+static void R_BuildDrawSegBins(void)
 {
-    int16_t* clipbot = floorclip;
-    int16_t* cliptop = ceilingclip;
+    memset(drawsegbins, 0, sizeof(drawsegbins));
 
-    fixed_t scale;
-    fixed_t lowscale;
+    const drawseg_t* drawsegs = _g->drawsegs;
 
-    for (int32_t x = spr->x1 ; x<=spr->x2 ; x++)
+    for (const drawseg_t* ds = drawsegs; ds < ds_p; ds++)
     {
-        clipbot[x] = viewheight;
-        cliptop[x] = -1;
+        if (!ds->silhouette && !ds->maskedtexturecol)
+            continue;
+
+        const int16_t i = ds - drawsegs;
+        const uint16_t bit = 1 << (i & 15);
+
+        for (int16_t b = ds->x1 >> DRAWSEG_BIN_SHIFT; b <= ds->x2 >> DRAWSEG_BIN_SHIFT; b++)
+            drawsegbins[b][i >> 4] |= bit;
     }
+}
 
 
-    // Scan drawsegs from end to start for obscuring segs.
-    // The first drawseg that has a greater scale is the clip seg.
+//
+// R_ClipSpriteToDrawSeg
+//
 
-    // Modified by Lee Killough:
-    // (pointer check was originally nonportable
-    // and buggy, by going past LEFT end of array):
+static void R_ClipSpriteToDrawSeg(const vissprite_t* spr, const drawseg_t* ds, int16_t* clipbot, int16_t* cliptop)
+{
+    fixed_t scale;
+    fixed_t lowscale;
 
-    const drawseg_t* drawsegs  =_g->drawsegs;
+    // determine if the drawseg obscures the sprite
+    if (ds->x1 > spr->x2 || ds->x2 < spr->x1 || (!ds->silhouette && !ds->maskedtexturecol))
+        return;      // does not cover sprite
 
-    for (const drawseg_t* ds = ds_p; ds-- > drawsegs; )  // new -- killough
+    const int32_t r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
+    const int32_t r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+
+    if (ds->scale1 > ds->scale2)
     {
-        // determine if the drawseg obscures the sprite
-        if (ds->x1 > spr->x2 || ds->x2 < spr->x1 || (!ds->silhouette && !ds->maskedtexturecol))
-            continue;      // does not cover sprite
+        lowscale = ds->scale2;
+        scale = ds->scale1;
+    }
+    else
+    {
+        lowscale = ds->scale1;
+        scale = ds->scale2;
+    }
 
-        const int32_t r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
-        const int32_t r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+    if (scale < spr->scale || (lowscale < spr->scale && !R_PointOnSegSide (spr->gx, spr->gy, ds->curline)))
+    {
+        if (ds->maskedtexturecol)       // masked mid texture?
+            R_RenderMaskedSegRange(ds, r1, r2);
+
+        return;               // seg is behind sprite
+    }
 
-        if (ds->scale1 > ds->scale2)
+    // clip this piece of the sprite
+    // killough 3/27/98: optimized and made much shorter
+
+    if (ds->silhouette & SIL_BOTTOM && spr->gz < ds->bsilheight) //bottom sil
+    {
+        for (int32_t x = r1; x <= r2; x++)
         {
-            lowscale = ds->scale2;
-            scale = ds->scale1;
+            if (clipbot[x] == viewheight)
+                clipbot[x] = ds->sprbottomclip[x];
         }
-        else
+
+    }
+
+    fixed_t gzt = spr->gz + (((int32_t)spr->patch_topoffset) << FRACBITS);
+
+    if (ds->silhouette & SIL_TOP && gzt > ds->tsilheight)   // top sil
+    {
+        for (int32_t x=r1; x <= r2; x++)
         {
-            lowscale = ds->scale1;
-            scale = ds->scale2;
+            if (cliptop[x] == -1)
+                cliptop[x] = ds->sprtopclip[x];
         }
+    }
+}
 
-        if (scale < spr->scale || (lowscale < spr->scale && !R_PointOnSegSide (spr->gx, spr->gy, ds->curline)))
-        {
-            if (ds->maskedtexturecol)       // masked mid texture?
-                R_RenderMaskedSegRange(ds, r1, r2);
 
-            continue;               // seg is behind sprite
-        }
+//
+// R_DrawSprite
+//
 
-        // clip this piece of the sprite
-        // killough 3/27/98: optimized and made much shorter
+static void R_DrawSprite (const vissprite_t* spr)
+{
+    int16_t* clipbot = floorclip;
+    int16_t* cliptop = ceilingclip;
 
-        if (ds->silhouette & SIL_BOTTOM && spr->gz < ds->bsilheight) //bottom sil
-        {
-            for (int32_t x = r1; x <= r2; x++)
-            {
-                if (clipbot[x] == viewheight)
-                    clipbot[x] = ds->sprbottomclip[x];
-            }
+    for (int32_t x = spr->x1 ; x<=spr->x2 ; x++)
+    {
+        clipbot[x] = viewheight;
+        cliptop[x] = -1;
+    }
 
-        }
 
-        fixed_t gzt = spr->gz + (((int32_t)spr->patch_topoffset) << FRACBITS);
+    // Scan drawsegs from end to start for obscuring segs.
+    // The first drawseg that has a greater scale is the clip seg.
 
-        if (ds->silhouette & SIL_TOP && gzt > ds->tsilheight)   // top sil
+    // Only the drawsegs in the bins of the sprite are visited,
+    // from the highest bit down to keep the original order.
+
+    const drawseg_t* drawsegs  =_g->drawsegs;
+
+    const int16_t words = ((ds_p - drawsegs) + 15) >> 4;
+
+    uint16_t mask[DRAWSEG_WORDS];
+
+    for (int16_t w = 0; w < words; w++)
+        mask[w] = 0;
+
+    for (int16_t b = spr->x1 >> DRAWSEG_BIN_SHIFT; b <= spr->x2 >> DRAWSEG_BIN_SHIFT; b++)
+    {
+        for (int16_t w = 0; w < words; w++)
+            mask[w] |= drawsegbins[b][w];
+    }
+
+    for (int16_t w = words; w-- > 0; )
+    {
+        uint16_t bits = mask[w];
+
+        for (int16_t i = 15; bits; i--)
         {
-            for (int32_t x=r1; x <= r2; x++)
+            if (bits & (1 << i))
             {
-                if (cliptop[x] == -1)
-                    cliptop[x] = ds->sprtopclip[x];
+                bits &= ~(1 << i);
+                drawsegchecks++;
+                R_ClipSpriteToDrawSeg(spr, &drawsegs[(w << 4) + i], clipbot, cliptop);
             }
         }
     }
@@ -1166,7 +1472,7 @@ static void R_DrawPSprite (pspdef_t *psp, int32_t lightlevel)
 
     flip = (boolean) SPR_FLIPPED(sprframe, 0);
 
-    const patch_t* patch = W_GetLumpByNum(sprframe->lump[0]+_g->firstspritelump);
+    const patch_t* patch = W_CacheLumpByNum(sprframe->lump[0]+_g->firstspritelump);
     // calculate edges of the shape
     fixed_t       tx;
     tx = psp->sx-160*FRACUNIT;
@@ -1214,7 +1520,6 @@ static void R_DrawPSprite (pspdef_t *psp, int32_t lightlevel)
 
     vis->patch_num       = sprframe->lump[0] + _g->firstspritelump;
     vis->patch_topoffset = patch->topoffset;
-    Z_Free(patch);
 
     if (_g->player.powers[pw_invisibility] > 4*32 || _g->player.powers[pw_invisibility] & 8)
         vis->colormap = NULL;                    // shadow draw
@@ -1257,25 +1562,104 @@ static void R_DrawPlayerSprites(void)
 // Rewritten by Lee Killough to avoid using unnecessary
 // linked lists, and to use faster sorting algorithm.
 //
-static int compare (const void* l, const void* r)
+// Sorts by decreasing scale.
+// The BSP is walked front to back, so the vissprites
+//  arrive nearly sorted and an insertion sort is cheap.
+// Beyond VISSPRITE_INSERTION_SORT vissprites
+//  an LSD radix sort on the scale takes over.
+// Both keep vissprites of equal scale in BSP order.
+
+#define VISSPRITE_INSERTION_SORT 32
+
+static uint16_t peakvissprites;     // most vissprites in a frame since R_ResetRenderStats
+static uint32_t totalvissprites;
+static uint32_t spriteframes;
+static uint32_t radixsorts;
+static uint32_t insertionshifts;
+
+static void R_InsertionSortVisSprites(int16_t count)
 {
-    const vissprite_t* vl = *(const vissprite_t**)l;
-    const vissprite_t* vr = *(const vissprite_t**)r;
+    for (int16_t i = 0; i < count; i++)
+    {
+        vissprite_t* vis = &_g->vissprites[i];
+        const fixed_t scale = vis->scale;
+
+        int16_t j = i;
 
-    return vr->scale - vl->scale;
+        while (j > 0 && vissprite_ptrs[j - 1]->scale < scale)
+        {
+            vissprite_ptrs[j] = vissprite_ptrs[j - 1];
+            j--;
+        }
+
+        insertionshifts += i - j;
+        vissprite_ptrs[j] = vis;
+    }
 }
 
-static void R_SortVisSprites (void)
+// The bucket offsets and their running sum are bytes,
+//  they count up to MAXVISSPRITES.
+typedef char assertRadixOffsetSize[MAXVISSPRITES < 256 ? 1 : -1];
+
+static void R_RadixSortVisSprites(int16_t count)
 {
-    int32_t i = num_vissprite;
+    static vissprite_t* tmp[MAXVISSPRITES];
+
+    vissprite_t** src = vissprite_ptrs;
+    vissprite_t** dst = tmp;
 
-    if (i)
+    uint32_t maxscale = 0;
+
+    for (int16_t i = 0; i < count; i++)
+    {
+        src[i] = &_g->vissprites[i];
+        maxscale |= src[i]->scale;
+    }
+
+    // The key is the complemented scale, so the result is decreasing.
+    for (uint8_t shift = 0; shift < 32 && (maxscale >> shift); shift += 8)
     {
-        while (--i>=0)
-            vissprite_ptrs[i] = _g->vissprites+i;
+        uint8_t offsets[256];
+        memset(offsets, 0, sizeof(offsets));
+
+        for (int16_t i = 0; i < count; i++)
+            offsets[(uint8_t)(~src[i]->scale >> shift)]++;
 
-        qsort(vissprite_ptrs, num_vissprite, sizeof (vissprite_t*), compare);
+        uint8_t sum = 0;
+        for (int16_t d = 0; d < 256; d++)
+        {
+            uint8_t c = offsets[d];
+            offsets[d] = sum;
+            sum += c;
+        }
+
+        for (int16_t i = 0; i < count; i++)
+            dst[offsets[(uint8_t)(~src[i]->scale >> shift)]++] = src[i];
+
+        vissprite_t** t = src;
+        src = dst;
+        dst = t;
     }
+
+    if (src != vissprite_ptrs)
+        memcpy(vissprite_ptrs, src, count * sizeof(vissprite_t*));
+
+    radixsorts++;
+}
+
+static void R_SortVisSprites (void)
+{
+    int16_t count = num_vissprite;
+
+    spriteframes++;
+    totalvissprites += count;
+    if (count > peakvissprites)
+        peakvissprites = count;
+
+    if (count <= VISSPRITE_INSERTION_SORT)
+        R_InsertionSortVisSprites(count);
+    else
+        R_RadixSortVisSprites(count);
 }
 
 //
@@ -1291,6 +1675,9 @@ static void R_DrawMasked(void)
 
     R_SortVisSprites();
 
+    if (num_vissprite)
+        R_BuildDrawSegBins();
+
     // draw all vissprites back to front
     for (i = num_vissprite ;--i>=0; )
         R_DrawSprite(vissprite_ptrs[i]);         // killough
@@ -1399,7 +1786,7 @@ static void R_ProjectSprite (mobj_t* thing, int32_t lightlevel)
     }
 
     const boolean flip = (boolean)SPR_FLIPPED(sprframe, rot);
-    const patch_t* patch = W_GetLumpByNum(sprframe->lump[rot] + _g->firstspritelump);
+    const patch_t* patch = W_CacheLumpByNum(sprframe->lump[rot] + _g->firstspritelump);
 
     /* calculate edges of the shape
      * cph 2003/08/1 - fraggle points out that this offset must be flipped
@@ -1465,8 +1852,6 @@ static void R_ProjectSprite (mobj_t* thing, int32_t lightlevel)
         vis->xiscale = iscale;
     }
 
-    Z_Free(patch);
-
     if (vis->x1 > x1)
         vis->startfrac += vis->xiscale*(vis->x1-x1);
 
@@ -1518,17 +1903,38 @@ static void R_AddSprites(subsector_t* subsec, int32_t lightlevel)
 
 // New function, by Lee Killough
 
+void R_InitVisplane(visplane_t *pl)
+{
+    memset(pl->top, UINT32_MAX, sizeof(pl->top));
+    pl->minx = SCREENWIDTH;
+    pl->maxx = -1;
+}
+
+
 static visplane_t *new_visplane(uint32_t hash)
 {
-    visplane_t *check = _g->freetail;
+    visplane_t *check;
 
-    if (!check)
-        check = Z_CallocLevel(sizeof(visplane_t));
-    else
+    if (_g->numvisplanes < VISPLANE_POOL)
+        check = &_g->visplanepool[_g->numvisplanes];
+    else if ((check = _g->freetail))
     {
         if (!(_g->freetail = _g->freetail->next))
             _g->freehead = &_g->freetail;
     }
+    else
+    {
+        check = Z_MallocLevel(sizeof(visplane_t), NULL);
+        R_InitVisplane(check);
+    }
+
+    if (++_g->numvisplanes > _g->peakvisplanes)
+        _g->peakvisplanes = _g->numvisplanes;
+
+    // top[] is only written between minx and maxx,
+    // so that's all that has to be cleared.
+    if (check->minx <= check->maxx)
+        memset(&check->top[check->minx], UINT32_MAX, check->maxx - check->minx + 1);
 
     check->next = _g->visplanes[hash];
     _g->visplanes[hash] = check;
@@ -1569,8 +1975,6 @@ static visplane_t *R_FindPlane(fixed_t height, int16_t picnum, int32_t lightleve
     check->minx = SCREENWIDTH; // Was SCREENWIDTH -- killough 11/98
     check->maxx = -1;
 
-    memset(check->top, UINT32_MAX, sizeof(check->top));
-
     check->modified = false;
 
     return check;
@@ -1592,8 +1996,6 @@ static visplane_t *R_DupPlane(const visplane_t *pl, int32_t start, int32_t stop)
     new_pl->minx = start;
     new_pl->maxx = stop;
 
-    memset(new_pl->top, UINT32_MAX, sizeof(new_pl->top));
-
     new_pl->modified = false;
 
     return new_pl;
@@ -1667,47 +2069,57 @@ static void R_DrawColumnInCache(const column_t* patch, byte* cache, int16_t orig
  * straight from const patch_t*.
 */
 
-#define CACHE_WAYS 4
-
-#define CACHE_MASK (CACHE_WAYS-1)
-#define CACHE_STRIDE (128 / CACHE_WAYS)
-#define CACHE_KEY_MASK (CACHE_STRIDE-1)
-
 #define CACHE_ENTRY(c, t) ((c << 16 | t))
 
-#define CACHE_HASH(c, t) (((c >> 1) ^ t) & CACHE_KEY_MASK)
+#define CACHE_HASH(c, t) (((c >> 1) ^ t) & (cacheStride-1))
 
-static uint32_t FindColumnCacheItem(int16_t texture, uint32_t column)
+//
+// FindCacheItem
+// The ways of a set are cacheStride entries apart.
+// Returns the entry holding cx,
+//  else an unused entry,
+//  else the least recently used entry of the set.
+//
+static uint32_t FindCacheItem(columncache_t* cache, uint32_t cx, uint32_t key)
 {
-    uint32_t cx = CACHE_ENTRY(column, texture);
+    uint16_t now = ++cache->clock;
 
-    uint32_t key = CACHE_HASH(column, texture);
+    uint32_t victim = key;
+    uint16_t oldest = 0;
 
-    uint32_t* cc = (uint32_t*)&columnCacheEntries[key];
-
-    uint32_t i = key;
-
-    do
+    for (uint32_t i = key; i < cacheEntries; i += cacheStride)
     {
-        uint32_t cy = *cc;
+        uint32_t cy = cache->entries[i];
 
-        if((cy == cx) || (cy == 0))
+        if (cy == cx)
+        {
+            cache->hits++;
+            cache->stamps[i] = now;
             return i;
+        }
 
-        cc+=CACHE_STRIDE;
-        i+=CACHE_STRIDE;
+        if (cy == 0)
+        {
+            victim = i;
+            break;
+        }
 
-    } while(i < 128);
+        uint16_t age = now - cache->stamps[i];
 
+        if (age > oldest)
+        {
+            oldest = age;
+            victim = i;
+        }
+    }
 
-    //No space. Random eviction.
-    return ((M_Random() & CACHE_MASK) * CACHE_STRIDE) + key;
+    cache->misses++;
+    cache->stamps[victim] = now;
+    return victim;
 }
 
-
-static const byte* R_ComposeColumn(const int16_t texture, const texture_t* tex, int32_t texcolumn, uint32_t iscale)
+static int32_t R_ComposeColumnIndex(const texture_t* tex, int32_t texcolumn, uint32_t iscale)
 {
-    //static int32_t total, misses;
     int32_t colmask;
 
     if(!highDetail)
@@ -1728,22 +2140,25 @@ static const byte* R_ComposeColumn(const int16_t texture, const texture_t* tex,
         colmask = 0xffff;
 
 
-    const int32_t xc = (texcolumn & colmask) & tex->widthmask;
+    return (texcolumn & colmask) & tex->widthmask;
+}
 
-    uint32_t cachekey = FindColumnCacheItem(texture, xc);
 
-    byte* colcache = &columnCache[cachekey*128];
-    uint32_t cacheEntry = columnCacheEntries[cachekey];
+static const byte* R_ComposeColumn(const int16_t texture, const texture_t* tex, int32_t texcolumn, uint32_t iscale)
+{
+    const int32_t xc = R_ComposeColumnIndex(tex, texcolumn, iscale);
+
+    uint32_t cachekey = FindCacheItem(&columnCache, CACHE_ENTRY(xc, texture), CACHE_HASH(xc, texture));
 
-    //total++;
+    byte* colcache = &columnCache.columns[cachekey*128];
+    uint32_t cacheEntry = columnCache.entries[cachekey];
 
     if(cacheEntry != CACHE_ENTRY(xc, texture))
     {
-        //misses++;
         byte tmpCache[128];
 
 
-        columnCacheEntries[cachekey] = CACHE_ENTRY(xc, texture);
+        columnCache.entries[cachekey] = CACHE_ENTRY(xc, texture);
 
         uint8_t i = 0;
         uint8_t patchcount = tex->patchcount;
@@ -1752,22 +2167,19 @@ static const byte* R_ComposeColumn(const int16_t texture, const texture_t* tex,
         {
             const texpatch_t* patch = &tex->patches[i];
 
-            const patch_t* realpatch = W_GetLumpByNum(patch->patch_num);
-
             const int16_t x1 = patch->originx;
 
             if (xc < x1)
                 continue;
 
-            const int16_t x2 = x1 + realpatch->width;
+            const int16_t x2 = x1 + V_NumPatchWidth(patch->patch_num);
 
             if (xc < x2)
             {
-                const column_t* patchcol = (const column_t *)((const byte *)realpatch + realpatch->columnofs[xc - x1]);
+                const column_t* patchcol = W_GetPatchColumn(patch->patch_num, xc - x1);
 
                 R_DrawColumnInCache (patchcol, tmpCache, patch->originy, tex->height);
             }
-            Z_Free(realpatch);
         } while(++i < patchcount);
 
         //Block copy will drop low 2 bits of len.
@@ -1777,26 +2189,183 @@ static const byte* R_ComposeColumn(const int16_t texture, const texture_t* tex,
     return colcache;
 }
 
+#if defined PRELIT_COLUMNS
+#define PRELIT_ENTRY(c, t, cm) (((uint32_t)(cm) << 24) | CACHE_ENTRY(c, t))
+
+#define PRELIT_HASH(c, t, cm) (((c >> 1) ^ t ^ (cm * 5)) & (cacheStride-1))
+
+//
+// R_GetPrelitColumn
+// Returns a wall column that has been translated
+//  through colormap cm, building it on a miss.
+//
+static const byte* R_GetPrelitColumn(int16_t texture, int32_t texcolumn, uint32_t iscale, int16_t cm)
+{
+    const texture_t* tex = R_GetTexture(texture);
+
+    int32_t xc;
+
+    if (!tex->overlapped)
+        xc = texcolumn & tex->widthmask;
+    else
+        xc = R_ComposeColumnIndex(tex, texcolumn, iscale);
+
+    uint32_t cx = PRELIT_ENTRY(xc, texture, cm);
+
+    uint32_t cachekey = FindCacheItem(&prelitCache, cx, PRELIT_HASH(xc, texture, cm));
+
+    byte* colcache = &prelitCache.columns[cachekey*128];
+
+    if (prelitCache.entries[cachekey] != cx)
+    {
+        prelitCache.entries[cachekey] = cx;
+
+        const byte* source;
+
+        if (!tex->overlapped)
+        {
+            uint32_t r = R_GetColumn(tex, xc);
+            source = (const byte*)W_GetPatchColumn(HIWORD(r), LOWORD(r)) + 3;
+        }
+        else
+            source = R_ComposeColumn(texture, tex, xc, iscale);
+
+        const lighttable_t* colormap = fullcolormap + cm*256;
+
+        int16_t height = tex->height < 128 ? tex->height : 128;
+
+        for (int16_t i = 0; i < height; i++)
+            colcache[i] = colormap[source[i]];
+
+        // The wall drawer wraps at 128,
+        //  so repeat shorter columns to fill the slot.
+        for (int16_t i = height; i < 128; i++)
+            colcache[i] = colcache[i - height];
+    }
+
+    return colcache;
+}
+#endif
+
 static void R_DrawSegTextureColumn(int16_t texture, int32_t texcolumn, draw_column_vars_t* dcvars)
 {
+#if defined PRELIT_COLUMNS
+    dcvars->source = R_GetPrelitColumn(texture, texcolumn, dcvars->iscale, rw_colormapnum);
+    R_DrawWallColumn (dcvars);
+#else
     const texture_t* tex = R_GetTexture(texture);
 
     if (!tex->overlapped)
     {
         uint32_t r = R_GetColumn(tex, texcolumn);
-        const patch_t* patch = W_GetLumpByNum(HIWORD(r));
-        texcolumn = LOWORD(r);
-        const column_t* column = (const column_t *) ((const byte *)patch + patch->columnofs[texcolumn]);
+        const column_t* column = W_GetPatchColumn(HIWORD(r), LOWORD(r));
 
         dcvars->source = (const byte*)column + 3;
-        R_DrawColumn (dcvars);
-        Z_Free(patch);
+        R_DrawWallColumn (dcvars);
     }
     else
     {
         dcvars->source = R_ComposeColumn(texture, tex, texcolumn, dcvars->iscale);
-        R_DrawColumn (dcvars);
+        R_DrawWallColumn (dcvars);
     }
+#endif
+}
+
+static void R_AllocColumnCache(columncache_t* cache)
+{
+    cache->entries = Z_MallocStatic((int32_t)cacheEntries * sizeof(uint32_t));
+    cache->stamps  = Z_MallocStatic((int32_t)cacheEntries * sizeof(uint16_t));
+    cache->columns = Z_MallocStatic((int32_t)cacheEntries * 128);
+
+    memset(cache->entries, 0, (int32_t)cacheEntries * sizeof(uint32_t));
+    memset(cache->stamps,  0, (int32_t)cacheEntries * sizeof(uint16_t));
+    cache->clock  = 0;
+    cache->hits   = 0;
+    cache->misses = 0;
+}
+
+
+//
+// R_InitColumnCache
+// Both numbers are rounded down to a power of two.
+// Zero selects the default.
+//
+void R_InitColumnCache(int16_t entries, int16_t ways)
+{
+    if (entries <= 0)
+        entries = COLUMN_CACHE_ENTRIES;
+    else if (entries > COLUMN_CACHE_MAX_ENTRIES)
+        I_Error("R_InitColumnCache: -colcache %d is above the limit of %d", entries, COLUMN_CACHE_MAX_ENTRIES);
+
+    if (ways <= 0)
+        ways = COLUMN_CACHE_WAYS;
+
+    cacheEntries = 1;
+    while (cacheEntries * 2 <= entries)
+        cacheEntries *= 2;
+
+    uint16_t w = 1;
+    while (w * 2 <= ways && w * 2 <= cacheEntries)
+        w *= 2;
+
+    cacheStride = cacheEntries / w;
+
+    R_AllocColumnCache(&columnCache);
+#if defined PRELIT_COLUMNS
+    R_AllocColumnCache(&prelitCache);
+#endif
+}
+
+
+static void R_DumpCacheStats(FILE* fp, const char* name, const columncache_t* cache)
+{
+    uint32_t total = cache->hits + cache->misses;
+
+    fprintf(fp, "  %s: %lu hits, %lu misses, %u%% hit rate\n", name,
+        (unsigned long)cache->hits, (unsigned long)cache->misses,
+        total ? (uint16_t)((cache->hits * 100ULL) / total) : 0);
+}
+
+
+//
+// R_DumpRenderStats
+//
+void R_DumpRenderStats(FILE* fp)
+{
+    fprintf(fp, "Column cache: %u entries, %u ways\n", cacheEntries, cacheEntries / cacheStride);
+    R_DumpCacheStats(fp, "composite", &columnCache);
+#if defined PRELIT_COLUMNS
+    R_DumpCacheStats(fp, "pre-lit", &prelitCache);
+#endif
+    fprintf(fp, "Visplanes: peak %u per frame, pool of %u overflowed in %lu frames\n",
+        _g->peakvisplanes, VISPLANE_POOL, (unsigned long)_g->visplaneoverflows);
+    fprintf(fp, "Vissprites: peak %u per frame, %lu in %lu frames, %lu radix sorts, %lu insertion sort shifts\n",
+        peakvissprites, (unsigned long)totalvissprites, (unsigned long)spriteframes,
+        (unsigned long)radixsorts, (unsigned long)insertionshifts);
+    fprintf(fp, "Drawsegs: %lu visited by sprites\n", (unsigned long)drawsegchecks);
+    fprintf(fp, "PVS: %lu nodes and subsectors skipped\n", (unsigned long)pvsculled);
+#if defined REUSE_FRAMES
+    fprintf(fp, "Frames: %lu reused\n", (unsigned long)reusedframes);
+#endif
+    fflush(fp);
+}
+
+
+void R_ResetRenderStats(void)
+{
+    columnCache.hits = columnCache.misses = 0;
+#if defined PRELIT_COLUMNS
+    prelitCache.hits = prelitCache.misses = 0;
+#endif
+    _g->peakvisplanes = 0;
+    _g->visplaneoverflows = 0;
+    peakvissprites = 0;
+    totalvissprites = spriteframes = radixsorts = insertionshifts = 0;
+    drawsegchecks = 0;
+    pvsculled = 0;
+#if defined REUSE_FRAMES
+    reusedframes = 0;
+#endif
 }
 
 //
@@ -1816,7 +2385,11 @@ static void R_RenderSegLoop (int32_t rw_x)
 
     R_SetDefaultDrawColumnVars(&dcvars);
 
+#if defined PRELIT_COLUMNS
+    rw_colormapnum = (R_ColourMap(rw_lightlevel) - fullcolormap) >> 8;
+#else
     dcvars.colormap = R_LoadColorMap(rw_lightlevel);
+#endif
 
     for ( ; rw_x < rw_stopx ; rw_x++)
     {
@@ -1980,6 +2553,10 @@ static void R_RenderSegLoop (int32_t rw_x)
         floorclip[rw_x] = fc_rwx;
         ceilingclip[rw_x] = cc_rwx;
     }
+
+#if defined WALL_TILE_COLUMNS
+    R_FlushWallTile();
+#endif
 }
 
 static boolean R_CheckOpenings(const int32_t start)
@@ -2687,8 +3264,107 @@ static boolean R_CheckBBox(const int16_t *bspcoord)
 
 
 
+//
+// Potentially visible set.
+// A set REJECT bit means the two sectors can't see each other,
+//  so nothing in such a sector has to be rendered.
+// When the viewer enters another sector, every node is marked
+//  if any subsector below it is in a sector that might be seen.
+// Unmarked nodes are treated as empty leaves.
+//
+
+static boolean R_SectorInPVS(int16_t sector)
+{
+    int32_t pnum = (int32_t)_g->pvssector * _g->numsectors + sector;
+
+    return sector == _g->pvssector || !(_g->rejectmatrix[pnum>>3] & (1 << (pnum&7)));
+}
+
+static boolean R_SubsectorInPVS(int16_t num)
+{
+    return R_SectorInPVS(_g->subsectors[num].sector - _g->sectors);
+}
+
+static boolean R_MarkPVSNode(uint16_t bspnum)
+{
+    if (bspnum & NF_SUBSECTOR)
+        return R_SubsectorInPVS(bspnum == 0xffff ? 0 : bspnum & (~NF_SUBSECTOR));
+
+    boolean front = R_MarkPVSNode(nodes[bspnum].children[0]);
+    boolean back  = R_MarkPVSNode(nodes[bspnum].children[1]);
+
+    if (front || back)
+        _g->pvsnodes[bspnum >> 3] |=  (1 << (bspnum & 7));
+    else
+        _g->pvsnodes[bspnum >> 3] &= ~(1 << (bspnum & 7));
+
+    return front || back;
+}
+
+static void R_SetupPVS(const player_t *player)
+{
+    if (_g->nopvs || !_g->rejectvalid || numnodes == 0)
+        return;
+
+    int16_t sector = player->mo->subsector->sector - _g->sectors;
+
+    // Freed at the end of the level.
+    if (!_g->pvsnodes)
+    {
+        Z_MallocLevel((numnodes + 7) >> 3, (void **)&_g->pvsnodes);
+        _g->pvssector = -1;
+    }
+
+    if (sector != _g->pvssector)
+    {
+        _g->pvssector = sector;
+        R_MarkPVSNode(numnodes - 1);
+    }
+}
+
+#if defined REUSE_FRAMES
+//
+// R_DirtySector
+// Changes outside the PVS of the viewer can't be seen.
+//
+void R_DirtySector(const sector_t *sec)
+{
+    if (!_g->pvsnodes || _g->pvssector < 0 || R_SectorInPVS(sec - _g->sectors))
+        R_DirtyWorld();
+}
+
+void R_DirtyMobj(const mobj_t *mobj)
+{
+    if (mobj->subsector && !(mobj->flags & MF_NOSECTOR))
+        R_DirtySector(mobj->subsector->sector);
+}
+#endif
+
+static boolean R_InPVS(int32_t bspnum)
+{
+    if (!_g->pvsnodes || _g->pvssector < 0)
+        return true;
+
+    boolean visible;
+
+    if (bspnum & NF_SUBSECTOR)
+        visible = R_SubsectorInPVS(bspnum == -1 ? 0 : bspnum & (~NF_SUBSECTOR));
+    else
+        visible = _g->pvsnodes[bspnum >> 3] & (1 << (bspnum & 7));
+
+    if (!visible)
+        pvsculled++;
+
+    return visible;
+}
+
+
 static boolean R_RenderBspSubsector(int32_t bspnum)
 {
+    // Outside the PVS, nothing to render below this node.
+    if (!R_InPVS(bspnum))
+        return true;
+
     // Found a subsector?
     if (bspnum & NF_SUBSECTOR)
     {
@@ -2822,9 +3498,109 @@ static void R_SetupFrame (player_t *player)
     _g->validcount++;
 
     highDetail = _g->highDetail;
+
+    R_SetupPVS(player);
 }
 
 
+#if defined REUSE_FRAMES
+//
+// Everything the view depends on, apart from the world itself.
+// The world bumps worldgeneration whenever something in sight changes.
+//
+
+typedef struct
+{
+    fixed_t viewx, viewy, viewz;
+    angle_t viewangle;
+    int32_t extralight;
+    int32_t gamma;                  // added to the light levels by R_ColourMap
+    const lighttable_t* fixedcolormap;
+    boolean highDetail;
+    uint32_t worldgeneration;
+    struct
+    {
+        const state_t *state;
+        fixed_t sx, sy;
+    } psprites[NUMPSPRITES];
+} viewsignature_t;
+
+static viewsignature_t lastsignature;
+static uint16_t* savedview;         // purgeable copy of the last view
+static boolean savedviewvalid;
+static boolean viewrepeated;
+
+#define VIEW_SIZE (SCREENWIDTH*viewheight*sizeof(uint16_t))
+
+//
+// R_ReuseView
+// Returns true if the last view has been copied to the screen.
+// Otherwise the view has to be rendered and R_SaveView called afterwards.
+//
+static boolean R_ReuseView(const player_t *player)
+{
+    viewsignature_t signature;
+
+    // Clear the padding for memcmp
+    memset(&signature, 0, sizeof(signature));
+
+    signature.viewx = viewx;
+    signature.viewy = viewy;
+    signature.viewz = viewz;
+    signature.viewangle = viewangle;
+    signature.extralight = extralight;
+    signature.gamma = _g->gamma;
+    signature.fixedcolormap = fixedcolormap;
+    signature.highDetail = highDetail;
+    signature.worldgeneration = _g->worldgeneration;
+
+    for (int16_t i = 0; i < NUMPSPRITES; i++)
+    {
+        signature.psprites[i].state = player->psprites[i].state;
+        signature.psprites[i].sx    = player->psprites[i].sx;
+        signature.psprites[i].sy    = player->psprites[i].sy;
+    }
+
+    if (memcmp(&signature, &lastsignature, sizeof(signature)))
+    {
+        lastsignature = signature;
+        savedviewvalid = false;
+        viewrepeated = false;
+        return false;
+    }
+
+    viewrepeated = true;
+
+    if (savedviewvalid && savedview)
+    {
+        Z_TouchCache(savedview);
+        memcpy(_g->screen, savedview, VIEW_SIZE);
+        reusedframes++;
+        return true;
+    }
+
+    return false;
+}
+
+//
+// R_SaveView
+// Only keep a copy once the same view has been rendered twice,
+// a moving viewer doesn't need the memory.
+//
+static void R_SaveView(void)
+{
+    if (!viewrepeated || fuzzdrawn)
+        return;
+
+    if (!savedview)
+        Z_MallocCache(VIEW_SIZE, (void **)&savedview);
+
+    memcpy(savedview, _g->screen, VIEW_SIZE);
+    savedviewvalid = true;
+}
+#endif
+
+
 //
 // R_RenderView
 //
@@ -2832,6 +3608,13 @@ void R_RenderPlayerView (player_t* player)
 {
     R_SetupFrame (player);
 
+#if defined REUSE_FRAMES
+    if (R_ReuseView(player))
+        return;
+
+    fuzzdrawn = false;
+#endif
+
     // Clear buffers.
     R_ClearClipSegs ();
     R_ClearDrawSegs ();
@@ -2844,6 +3627,10 @@ void R_RenderPlayerView (player_t* player)
     R_DrawPlanes ();
 
     R_DrawMasked ();
+
+#if defined REUSE_FRAMES
+    R_SaveView();
+#endif
 }
 
 
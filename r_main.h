@@ -36,6 +36,8 @@
 #ifndef __R_MAIN__
 #define __R_MAIN__
 
+#include <stdio.h>
+
 #include "d_player.h"
 #include "r_data.h"
 
@@ -48,6 +50,16 @@
 
 #define MAXVISPLANES 32    /* must be a power of 2 */
 
+// Visplanes per frame that come from the pool,
+// further visplanes are allocated from the zone.
+#define VISPLANE_POOL 32
+
+// Keep a copy of the last rendered view and show it again
+// while the viewer and everything in sight stand still.
+#if !defined _M_I86
+#define REUSE_FRAMES
+#endif
+
 
 typedef struct {
   int32_t                 x;
@@ -102,6 +114,10 @@ uint32_t R_GetColumn(const texture_t* texture, int32_t texcolumn);
 
 const lighttable_t* R_LoadColorMap(int32_t lightlevel);
 
+void R_InitColumnCache(int16_t entries, int16_t ways);
+void R_DumpRenderStats(FILE* fp);
+void R_ResetRenderStats(void);
+
 //
 // REFRESH - the actual rendering functions.
 //
@@ -112,5 +128,18 @@ void R_DrawColumn (const draw_column_vars_t *dcvars);
 
 void R_DrawPlanes (void);
 void R_ClearPlanes(void);
+void R_InitVisplane(visplane_t *pl);
+
+// Tell the renderer that the world has changed,
+// so the last frame can't be reused.
+#if defined REUSE_FRAMES
+#define R_DirtyWorld() (_g->worldgeneration++)
+void R_DirtySector(const sector_t *sec);
+void R_DirtyMobj(const mobj_t *mobj);
+#else
+#define R_DirtyWorld()
+#define R_DirtySector(sec)
+#define R_DirtyMobj(mobj)
+#endif
 
 #endif
@@ -25,6 +25,7 @@
 
 #include "r_defs.h"
 #include "r_main.h"
+#include "i_system.h"
 
 #include "globdata.h"
 
@@ -240,22 +241,23 @@ static fixed_t distscale(uint8_t x)
 	return distscaleTable[x];
 }
 #else
-static FILE *fileDistScale;
-static FILE *fileYSlope;
-
 static fixed_t yslope(uint8_t y)
 {
+	if (_g->tableYSlope)
+		return _g->tableYSlope[y];
+
 	fixed_t s;
-	fseek(fileYSlope, y * sizeof(fixed_t), SEEK_SET);
-	fread(&s, sizeof(fixed_t), 1, fileYSlope);
+	R_ReadLookupTable(_g->fileYSlope, y * sizeof(fixed_t), &s, sizeof(fixed_t));
 	return s;
 }
 
 static fixed_t distscale(uint8_t x)
 {
+	if (_g->tableDistScale)
+		return _g->tableDistScale[x];
+
 	fixed_t d;
-	fseek(fileDistScale, x * sizeof(fixed_t), SEEK_SET);
-	fread(&d, sizeof(fixed_t), 1, fileDistScale);
+	R_ReadLookupTable(_g->fileDistScale, x * sizeof(fixed_t), &d, sizeof(fixed_t));
 	return d;
 }
 #endif
@@ -264,17 +266,78 @@ static fixed_t distscale(uint8_t x)
 static fixed_t planeheight;
 static fixed_t basexscale, baseyscale;
 
+
+//
+// Span setup tables.
+// The distance and step of a row only depend on the plane height,
+//  so the planes are drawn one height at a time
+//  and every row is computed once per height.
+// The direction of a column, scaled by distscale,
+//  only changes with the view angle.
+//
+
+static uint16_t rowstamp[SCREENHEIGHT];    // height the row was computed for
+static fixed_t  rowdistance[SCREENHEIGHT];
+static uint32_t rowstep[SCREENHEIGHT];
+static uint16_t planestamp;                // bumped for every height drawn
+
+static fixed_t columncos[SCREENWIDTH];  // cosine * distscale
+static fixed_t columnsin[SCREENWIDTH];  // sine * distscale
+static angle_t columnangle;
+static boolean columnsvalid;
+
+
+static void R_SetupPlaneColumns(void)
+{
+    if (columnsvalid && columnangle == viewangle)
+        return;
+
+    for (int16_t x = 0; x < SCREENWIDTH; x++)
+    {
+        angle_t angle = (viewangle + xtoviewangle(x))>>ANGLETOFINESHIFT;
+        fixed_t scale = distscale(x);
+
+        columncos[x] = FixedMul(finecosine(angle), scale);
+        columnsin[x] = FixedMul(finesine(  angle), scale);
+    }
+
+    columnangle  = viewangle;
+    columnsvalid = true;
+}
+
+
+//
+// R_SetupPlaneRows
+// Invalidates the rows of the previous height.
+//
+static void R_SetupPlaneRows(void)
+{
+    // Zero marks rows that were never computed.
+    if (++planestamp == 0)
+    {
+        memset(rowstamp, 0, sizeof(rowstamp));
+        planestamp = 1;
+    }
+}
+
+
 static void R_MapPlane(uint32_t y, uint32_t x1, uint32_t x2, draw_span_vars_t *dsvars)
 {    
-    const fixed_t distance = FixedMul(planeheight, yslope(y));
-    dsvars->step = ((FixedMul(distance,basexscale) << 10) & 0xffff0000) | ((FixedMul(distance,baseyscale) >> 6) & 0x0000ffff);
+    if (rowstamp[y] != planestamp)
+    {
+        const fixed_t distance = FixedMul(planeheight, yslope(y));
+
+        rowdistance[y] = distance;
+        rowstep[y] = ((FixedMul(distance,basexscale) << 10) & 0xffff0000) | ((FixedMul(distance,baseyscale) >> 6) & 0x0000ffff);
+        rowstamp[y] = planestamp;
+    }
 
-    fixed_t length = FixedMul (distance, distscale(x1));
-    angle_t angle = (viewangle + xtoviewangle(x1))>>ANGLETOFINESHIFT;
+    const fixed_t distance = rowdistance[y];
+    dsvars->step = rowstep[y];
 
     // killough 2/28/98: Add offsets
-    uint32_t xfrac =  viewx + FixedMul(finecosine(angle), length);
-    uint32_t yfrac = -viewy - FixedMul(finesine(  angle), length);
+    uint32_t xfrac =  viewx + FixedMul(distance, columncos[x1]);
+    uint32_t yfrac = -viewy - FixedMul(distance, columnsin[x1]);
 
     dsvars->position = ((xfrac << 10) & 0xffff0000) | ((yfrac >> 6)  & 0x0000ffff);
 
@@ -338,13 +401,10 @@ static void R_DrawSky(visplane_t *pl)
 			int32_t xc = (viewangle + xtoviewangle(x)) >> ANGLETOSKYSHIFT;
 
 			uint32_t r = R_GetColumn(tex, xc);
-			const patch_t* patch = W_GetLumpByNum(HIWORD(r));
-			xc = LOWORD(r);
-			const column_t* column = (const column_t *) ((const byte *)patch + patch->columnofs[xc]);
+			const column_t* column = W_GetPatchColumn(HIWORD(r), LOWORD(r));
 
 			dcvars.source = (const byte*)column + 3;
 			R_DrawColumn(&dcvars);
-			Z_Free(patch);
 		}
 	}
 }
@@ -377,10 +437,8 @@ static void R_DoDrawPlane(visplane_t *pl)
 #else
             draw_span_vars_t dsvars;
 
-            dsvars.source   = W_GetLumpByNum(firstflat + flattranslation[pl->picnum]);
             dsvars.colormap = R_LoadColorMap(pl->lightlevel);
-
-            planeheight = D_abs(pl->height - viewz);
+            dsvars.source   = W_CacheLumpByNum(firstflat + flattranslation[pl->picnum]);
 
             const int32_t stop = pl->maxx + 1;
 
@@ -390,8 +448,6 @@ static void R_DoDrawPlane(visplane_t *pl)
             {
                 R_MakeSpans(x, pl->top[x - 1], pl->bottom[x - 1], pl->top[x], pl->bottom[x], &dsvars);
             }
-
-            Z_Free(dsvars.source);
 #endif
         }
     }
@@ -405,6 +461,52 @@ static void R_DoDrawPlane(visplane_t *pl)
 
 void R_DrawPlanes (void)
 {
+#if !defined FLAT_SPAN
+    R_SetupPlaneColumns();
+
+    // Draw the planes nearest height first,
+    //  every height once, see R_SetupPlaneRows.
+    boolean first = true;
+
+    while (true)
+    {
+        boolean found = false;
+        fixed_t next  = 0;
+
+        for (int8_t i = 0; i < MAXVISPLANES; i++)
+        {
+            for (visplane_t *pl = _g->visplanes[i]; pl; pl = pl->next)
+            {
+                if (pl->modified)
+                {
+                    fixed_t height = D_abs(pl->height - viewz);
+
+                    if ((first || height > planeheight) && (!found || height < next))
+                    {
+                        next  = height;
+                        found = true;
+                    }
+                }
+            }
+        }
+
+        if (!found)
+            break;
+
+        planeheight = next;
+        first       = false;
+        R_SetupPlaneRows();
+
+        for (int8_t i = 0; i < MAXVISPLANES; i++)
+        {
+            for (visplane_t *pl = _g->visplanes[i]; pl; pl = pl->next)
+            {
+                if (pl->modified && D_abs(pl->height - viewz) == planeheight)
+                    R_DoDrawPlane(pl);
+            }
+        }
+    }
+#else
     for (int8_t i = 0; i < MAXVISPLANES; i++)
     {
         visplane_t *pl = _g->visplanes[i];
@@ -417,6 +519,7 @@ void R_DrawPlanes (void)
             pl = pl->next;
         }
     }
+#endif
 }
 
 
@@ -434,9 +537,41 @@ void R_ClearPlanes(void)
         floorclip[i] = viewheight, ceilingclip[i] = -1;
 
 
+    if (!_g->visplanepool)
+    {
+        _g->visplanepool = Z_MallocLevel(VISPLANE_POOL * sizeof(visplane_t), (void **)&_g->visplanepool);
+
+        for (int8_t i = 0; i < VISPLANE_POOL; i++)
+            R_InitVisplane(&_g->visplanepool[i]);
+    }
+
+    if (_g->numvisplanes > VISPLANE_POOL)
+        _g->visplaneoverflows++;
+
+    _g->numvisplanes = 0;
+
+    // Only the visplanes from the zone go on the free list,
+    // the pool is reused from the start every frame.
     for (int8_t i = 0; i < MAXVISPLANES; i++)    // new code -- killough
-        for (*_g->freehead = _g->visplanes[i], _g->visplanes[i] = NULL; *_g->freehead; )
-            _g->freehead = &(*_g->freehead)->next;
+    {
+        visplane_t *pl = _g->visplanes[i];
+        _g->visplanes[i] = NULL;
+
+        while (pl)
+        {
+            visplane_t *next = pl->next;
+
+            if (pl < _g->visplanepool || pl >= &_g->visplanepool[VISPLANE_POOL])
+            {
+                *_g->freehead = pl;
+                _g->freehead = &pl->next;
+            }
+
+            pl = next;
+        }
+    }
+
+    *_g->freehead = NULL;
 
     _g->lastopening = _g->openings;
 
@@ -468,13 +603,13 @@ void R_InitFlats(void)
 
 #if !defined FLAT_SPAN
 	// DistScale
-	fileDistScale = fopen("DISTSCAL.LMP", "rb");
-	if (fileDistScale == NULL)
+	_g->fileDistScale = fopen("DISTSCAL.LMP", "rb");
+	if (_g->fileDistScale == NULL)
 		I_Error("Can't open DISTSCAL.LMP.");
 
 	// YSlope
-	fileYSlope = fopen("YSLOPE.LMP", "rb");
-	if (fileYSlope == NULL)
+	_g->fileYSlope = fopen("YSLOPE.LMP", "rb");
+	if (_g->fileYSlope == NULL)
 		I_Error("Can't open YSLOPE.LMP.");
 #endif
 }
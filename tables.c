@@ -46,6 +46,7 @@
 
 #include <stddef.h>
 #include "w_wad.h"
+#include "z_zone.h"
 #include "tables.h"
 #include "globdata.h"
 
@@ -1359,14 +1360,84 @@ static const angle_t xtoviewangleTable[121] =
 #endif
 
 
+//
+// Block cache for the lookup tables that stay on disk.
+// The .LMP files are read a page at a time,
+// and the pages are kept in a small set associative cache.
+// The ways of a set are kept in most recently used order,
+// so the last way of a set is the one that gets evicted.
+//
+
+#define LTCACHE_PAGESHIFT	8
+#define LTCACHE_PAGESIZE	(1 << LTCACHE_PAGESHIFT)
+#define LTCACHE_SETS		16
+#define LTCACHE_WAYS		4
+
+typedef struct
+{
+	FILE*    file;	// NULL if the line is empty
+	uint16_t page;
+	byte*    data;
+} ltcacheline_t;
+
+static ltcacheline_t ltcache[LTCACHE_SETS][LTCACHE_WAYS];
+static boolean ltcacheenabled;
+
+
+void R_ReadLookupTable(FILE* fp, uint16_t offset, void* entry, size_t size)
+{
+	if (!ltcacheenabled)
+	{
+		fseek(fp, offset, SEEK_SET);
+		fread(entry, size, 1, fp);
+		return;
+	}
+
+	// An entry never straddles two pages,
+	// because the page size is a multiple of the entry sizes.
+	uint16_t page = offset >> LTCACHE_PAGESHIFT;
+
+	ltcacheline_t* set = ltcache[(page + fileno(fp) * 5) & (LTCACHE_SETS - 1)];
+
+	uint8_t way = 0;
+	while (way < LTCACHE_WAYS - 1 && !(set[way].file == fp && set[way].page == page))
+		way++;
+
+	ltcacheline_t line = set[way];
+
+	if (line.file == fp && line.page == page)
+		_g->ltcachehits++;
+	else
+	{
+		// Not found, so way is the least recently used line. Evict it.
+		_g->ltcachemisses++;
+
+		line.file = fp;
+		line.page = page;
+		fseek(fp, ((int32_t)page) << LTCACHE_PAGESHIFT, SEEK_SET);
+		fread(line.data, 1, LTCACHE_PAGESIZE, fp);
+	}
+
+	// Move the line to the front of the set
+	for (; way > 0; way--)
+		set[way] = set[way - 1];
+
+	set[0] = line;
+
+	memcpy(entry, &line.data[offset & (LTCACHE_PAGESIZE - 1)], size);
+}
+
+
 fixed_t finesine(int16_t x)
 {
 #if 0
 	return finesineTable[x];
 #else
+	if (_g->tableFineSine)
+		return _g->tableFineSine[x];
+
 	fixed_t s;
-	fseek(_g->fileFineSine, x * sizeof(fixed_t), SEEK_SET);
-	fread(&s, sizeof(fixed_t), 1, _g->fileFineSine);
+	R_ReadLookupTable(_g->fileFineSine, x * sizeof(fixed_t), &s, sizeof(fixed_t));
 	return s;
 #endif
 }
@@ -1376,9 +1447,11 @@ fixed_t finecosine(int16_t x)
 #if 0
 	return finecosineTable[x];
 #else
+	if (_g->tableFineSine)
+		return _g->tableFineSine[x + (FINEANGLES/4)];
+
 	fixed_t c;
-	fseek(_g->fileFineSine, x * sizeof(fixed_t) + (FINEANGLES/4) * sizeof(fixed_t), SEEK_SET);
-	fread(&c, sizeof(fixed_t), 1, _g->fileFineSine);
+	R_ReadLookupTable(_g->fileFineSine, x * sizeof(fixed_t) + (FINEANGLES/4) * sizeof(fixed_t), &c, sizeof(fixed_t));
 	return c;
 #endif
 }
@@ -1389,9 +1462,113 @@ angle_t xtoviewangle(int8_t x)
 #if 0
 	return xtoviewangleTable[x];
 #else
+	if (_g->tableXToViewAngle)
+		return _g->tableXToViewAngle[x];
+
 	angle_t viewangle;
-	fseek(_g->fileXToViewAngle, x * sizeof(angle_t), SEEK_SET);
-	fread(&viewangle, sizeof(angle_t), 1, _g->fileXToViewAngle);
+	R_ReadLookupTable(_g->fileXToViewAngle, x * sizeof(angle_t), &viewangle, sizeof(angle_t));
 	return viewangle;
 #endif
 }
+
+
+//
+// Lookup table residency.
+// Every lookup table can be read from its .LMP file one entry at a time.
+// At startup, as many tables as the zone can spare are loaded into memory.
+// The tables are tried from hot to cold, so the tables that are read
+// the most per byte of memory they take are the first to be loaded.
+//
+
+// Zone memory that is kept free for levels, patches and thinkers
+#define LOOKUPTABLE_RESERVE (256 * 1024L)
+
+typedef struct
+{
+	const char*  name;
+	FILE*        file;
+	const void** table;
+	uint16_t     size;   // in bytes
+} lookuptable_t;
+
+
+void R_InitLookupTables(void)
+{
+	// In order of hotness
+	const lookuptable_t lookuptables[] =
+	{
+		{"XVIEWANG.LMP", _g->fileXToViewAngle, (const void**)&_g->tableXToViewAngle, (SCREENWIDTH + 1) * sizeof(angle_t)},
+		{"YSLOPE.LMP",   _g->fileYSlope,       (const void**)&_g->tableYSlope,       SCREENHEIGHT       * sizeof(fixed_t)},
+		{"DISTSCAL.LMP", _g->fileDistScale,    (const void**)&_g->tableDistScale,    SCREENWIDTH        * sizeof(fixed_t)},
+		{"VIEWANGX.LMP", _g->fileViewAngleToX, (const void**)&_g->tableViewAngleToX, (FINEANGLES / 2)   * sizeof(int8_t)},
+		{"TAN2ANG.LMP",  _g->fileTanToAngle,   (const void**)&_g->tableTanToAngle,   2049               * sizeof(angle_t)},
+		{"FINETAN.LMP",  _g->fileFineTan,      (const void**)&_g->tableFineTan,      (FINEANGLES / 2)   * sizeof(fixed_t)},
+		{"FINESINE.LMP", _g->fileFineSine,     (const void**)&_g->tableFineSine,     (FINEANGLES * 5/4) * sizeof(fixed_t)}
+	};
+
+	int32_t total = 0;
+
+	for (uint8_t i = 0; i < sizeof(lookuptables) / sizeof(lookuptables[0]); i++)
+		if (lookuptables[i].file)
+			total += lookuptables[i].size;
+
+	// When not every table fits, the cache for the tables
+	// that stay on disk goes first, before the cold tables
+	// take the memory it needs.
+	const int32_t cachesize = LTCACHE_SETS * LTCACHE_WAYS * LTCACHE_PAGESIZE;
+	byte* cachedata = NULL;
+
+	if (Z_GetLargestFreeBlockSize() < LOOKUPTABLE_RESERVE + total
+		&& Z_GetLargestFreeBlockSize() >= LOOKUPTABLE_RESERVE + cachesize)
+		cachedata = Z_MallocStatic(cachesize);
+
+	boolean ondisk = false;
+
+	for (uint8_t i = 0; i < sizeof(lookuptables) / sizeof(lookuptables[0]); i++)
+	{
+		const lookuptable_t* lt = &lookuptables[i];
+
+		// Not used by this build
+		if (lt->file == NULL)
+			continue;
+
+		if (Z_GetLargestFreeBlockSize() < LOOKUPTABLE_RESERVE + lt->size)
+		{
+			printf("\t%s stays on disk\n", lt->name);
+			ondisk = true;
+			continue;
+		}
+
+		void* table = Z_MallocStatic(lt->size);
+		fseek(lt->file, 0, SEEK_SET);
+		fread(table, lt->size, 1, lt->file);
+		*lt->table = table;
+
+		printf("\t%s loaded into memory\n", lt->name);
+	}
+
+	if (cachedata && !ondisk)
+	{
+		// Everything fitted after all
+		Z_Free(cachedata);
+		cachedata = NULL;
+	}
+
+	if (cachedata)
+	{
+		byte* data = cachedata;
+
+		for (uint8_t set = 0; set < LTCACHE_SETS; set++)
+		{
+			for (uint8_t way = 0; way < LTCACHE_WAYS; way++)
+			{
+				ltcache[set][way].data = data;
+				data += LTCACHE_PAGESIZE;
+			}
+		}
+
+		ltcacheenabled = true;
+
+		printf("\t%ld bytes allocated for lookup table cache\n", cachesize);
+	}
+}
@@ -42,6 +42,7 @@
 #ifndef __TABLES__
 #define __TABLES__
 
+#include <stdio.h>
 #include "m_fixed.h"
 
 #define FINEANGLES              8192
@@ -65,4 +66,7 @@ fixed_t finecosine(int16_t x);
 
 angle_t xtoviewangle(int8_t x);
 
+void R_InitLookupTables(void);
+void R_ReadLookupTable(FILE* fp, uint16_t offset, void* entry, size_t size);
+
 #endif
@@ -109,7 +109,7 @@ static void V_DrawPatch(int32_t x, int32_t y, const patch_t* patch)
                 uint16_t color = source[frac >> FRACBITS];
 
                 //The GBA must write in 16bits.
-                if((uint32_t)dest & 1)
+                if((uintptr_t)dest & 1)
                 {
                     //Odd addreses, we combine existing pixel with new one.
                     uint16_t* dest16 = (uint16_t*)(dest - 1);
@@ -152,9 +152,9 @@ void V_DrawPatchNoScale(int32_t x, int32_t y, const patch_t* patch)
     {
         const column_t* column = (const column_t*)((const byte*)patch + patch->columnofs[col]);
 
-        uint32_t odd_addr = (uint32_t)desttop & 1;
+        uint32_t odd_addr = (uintptr_t)desttop & 1;
 
-        byte* desttop_even = (byte*)((uint32_t)desttop & ~1);
+        byte* desttop_even = (byte*)((uintptr_t)desttop & ~1);
 
         // step through the posts in a column
         while (column->topdelta != 0xff)
@@ -188,9 +188,8 @@ void V_DrawPatchNoScale(int32_t x, int32_t y, const patch_t* patch)
 
 void V_DrawNumPatch(int32_t x, int32_t y, int16_t num)
 {
-	const patch_t* patch = W_GetLumpByNum(num);
+	const patch_t* patch = W_CacheLumpByNum(num);
 	V_DrawPatch(x, y, patch);
-	Z_Free(patch);
 }
 
 
@@ -204,7 +203,6 @@ void V_DrawNamePatch(int32_t x, int32_t y, const char *name)
 
 void V_DrawNumPatchNoScale(int32_t x, int32_t y, int16_t num)
 {
-	const patch_t* patch = W_GetLumpByNum(num);
+	const patch_t* patch = W_CacheLumpByNum(num);
 	V_DrawPatchNoScale(x, y, patch);
-	Z_Free(patch);
 }
@@ -43,6 +43,7 @@
 #endif
 
 #include <fcntl.h>
+#include <stddef.h>
 
 #include "doomstat.h"
 #include "d_net.h"
@@ -82,7 +83,43 @@ typedef struct
 
 static wadinfo_t header;
 
-static filelump_t fileinfo;
+// The WAD directory is read once by W_Init and kept in memory,
+// so lump lookups don't have to touch the disk.
+static const filelump_t* fileinfo;
+
+// killough 1/31/98: hash table for fast lump lookups.
+// Each chain is threaded through lumpnext[] and terminated by -1.
+static int16_t* lumphash;
+static int16_t* lumpnext;
+static uint16_t lumphashmask;
+
+// Purgable copies of the lumps the renderer draws from, indexed by lump number.
+// The zone sets an entry back to NULL when it throws the lump out.
+static void** lumpcache;
+
+// Purgable copies of the patch headers and column offsets,
+// for patches that are streamed column by column.
+static void** patchheadercache;
+
+// Build option: on low memory targets,
+// read only the posts of the requested column from disk
+// instead of the whole patch.
+#if defined _M_I86
+#define STREAM_PATCH_COLUMNS
+#endif
+
+// Largest column that is streamed, taller columns load the whole patch
+#define COLUMN_BUFFER_SIZE 512
+
+#if defined STREAM_PATCH_COLUMNS
+// Purgable copies of the last streamed columns, direct mapped,
+// so columns that are drawn every frame aren't read every frame.
+#define STREAMED_COLUMNS 256
+
+static void** streamedcolumns;
+static uint32_t* streamedkeys;		// lump number << 16 | column
+#endif
+
 
 //
 // LUMP BASED ROUTINES.
@@ -95,40 +132,62 @@ static const filelump_t* PUREFUNC W_FindLumpByNum(int16_t num)
 		I_Error("W_FindLumpByNum: %i >= numlumps", num);
 #endif
 
-	fseek(_g->fileWAD, header.infotableofs + num * sizeof(filelump_t), SEEK_SET);
-	fread(&fileinfo, sizeof(filelump_t), 1, _g->fileWAD);
-	return &fileinfo;
+	return &fileinfo[num];
 }
 
 
-// W_GetNumForName
-// bombs out if not found.
 //
-int16_t PUREFUNC W_GetNumForName(const char *name)     // killough -- const added
+// W_LumpNameHash
+// killough 1/31/98: hash function for lump names.
+// The name is expected to be padded with zeros to 8 characters,
+// just like the names in the directory, so the hash of a lookup name
+// and the hash of a directory entry agree.
+//
+static uint16_t PUREFUNC W_LumpNameHash(const char *s)
+{
+	uint16_t hash;
+	(void) ((hash =        s[0], s[1]) &&
+	        (hash = hash*3+s[1], s[2]) &&
+	        (hash = hash*2+s[2], s[3]) &&
+	        (hash = hash*2+s[3], s[4]) &&
+	        (hash = hash*2+s[4], s[5]) &&
+	        (hash = hash*2+s[5], s[6]) &&
+	        (hash = hash*2+s[6],
+	         hash = hash*2+s[7])
+	       );
+	return hash;
+}
+
+
+int16_t PUREFUNC W_CheckNumForName(const char *name)
 {
 	int64_t nameint;
 	strncpy((char*)&nameint, name, 8);
 
-#if BACKWARDS
-	for (int16_t i = header.numlumps - 1; i >= 0; i--)
-#else
-	for (int16_t i = 0; i < header.numlumps; i++)
-#endif
+	for (int16_t i = lumphash[W_LumpNameHash((const char*)&nameint) & lumphashmask]; i != -1; i = lumpnext[i])
 	{
-		fseek(_g->fileWAD, header.infotableofs + i * sizeof(filelump_t), SEEK_SET);
-		fread(&fileinfo, sizeof(filelump_t), 1, _g->fileWAD);
-
-		if (nameint == *(int64_t*)fileinfo.name)
-		{
+		if (nameint == *(const int64_t*)fileinfo[i].name)
 			return i;
-		}
 	}
 
-	I_Error("W_GetNumForName: %.8s not found", name);
 	return -1;
 }
 
 
+// W_GetNumForName
+// bombs out if not found.
+//
+int16_t PUREFUNC W_GetNumForName(const char *name)     // killough -- const added
+{
+	int16_t i = W_CheckNumForName(name);
+
+	if (i == -1)
+		I_Error("W_GetNumForName: %.8s not found", name);
+
+	return i;
+}
+
+
 const char* PUREFUNC W_GetNameForNum(int16_t num)
 {
 	const filelump_t* lump = W_FindLumpByNum(num);
@@ -136,6 +195,42 @@ const char* PUREFUNC W_GetNameForNum(int16_t num)
 }
 
 
+//
+// W_InitLumpHash
+// killough 1/31/98: Initialize lump hash table
+//
+static void W_InitLumpHash(void)
+{
+	// Use a power of two number of chains,
+	// so a chain can be selected with a mask instead of a modulo.
+	uint16_t numchains = 1;
+	while (numchains * 2 <= header.numlumps)
+		numchains <<= 1;
+
+	lumphashmask = numchains - 1;
+
+	lumphash = Z_MallocStatic(numchains * sizeof(int16_t));
+	lumpnext = Z_MallocStatic(header.numlumps * sizeof(int16_t));
+
+	for (uint16_t i = 0; i < numchains; i++)
+		lumphash[i] = -1;
+
+	// Insert the lumps in reverse order, so the first lump with a given name
+	// ends up at the head of its chain.
+	// That's the one the old linear search returned.
+#if BACKWARDS
+	for (int16_t i = 0; i < header.numlumps; i++)
+#else
+	for (int16_t i = header.numlumps - 1; i >= 0; i--)
+#endif
+	{
+		uint16_t j = W_LumpNameHash(fileinfo[i].name) & lumphashmask;
+		lumpnext[i] = lumphash[j];
+		lumphash[j] = i;
+	}
+}
+
+
 void W_Init(void)
 {
 	printf("\tadding doom1.wad\n");
@@ -143,6 +238,26 @@ void W_Init(void)
 
 	fseek(_g->fileWAD, 0, SEEK_SET);
 	fread(&header, sizeof(header), 1, _g->fileWAD);
+
+	filelump_t* directory = Z_MallocStatic(header.numlumps * sizeof(filelump_t));
+	fseek(_g->fileWAD, header.infotableofs, SEEK_SET);
+	fread(directory, sizeof(filelump_t), header.numlumps, _g->fileWAD);
+	fileinfo = directory;
+
+	W_InitLumpHash();
+
+	lumpcache = Z_MallocStatic(header.numlumps * sizeof(*lumpcache));
+	memset(lumpcache, 0, header.numlumps * sizeof(*lumpcache));
+
+	patchheadercache = Z_MallocStatic(header.numlumps * sizeof(*patchheadercache));
+	memset(patchheadercache, 0, header.numlumps * sizeof(*patchheadercache));
+
+#if defined STREAM_PATCH_COLUMNS
+	streamedcolumns = Z_MallocStatic(STREAMED_COLUMNS * sizeof(*streamedcolumns));
+	memset(streamedcolumns, 0, STREAMED_COLUMNS * sizeof(*streamedcolumns));
+
+	streamedkeys = Z_MallocStatic(STREAMED_COLUMNS * sizeof(*streamedkeys));
+#endif
 }
 
 
@@ -160,26 +275,12 @@ int32_t PUREFUNC W_LumpLength(int16_t num)
 
 static const filelump_t* PUREFUNC W_GetFileInfoForName(const char *name)
 {
-	int64_t nameint;
-	strncpy((char*)&nameint, name, 8);
+	int16_t i = W_CheckNumForName(name);
 
-#if BACKWARDS
-	for (int16_t i = header.numlumps - 1; i >= 0; i--)
-#else
-	for (int16_t i = 0; i < header.numlumps; i++)
-#endif
-	{
-		fseek(_g->fileWAD, header.infotableofs + i * sizeof(filelump_t), SEEK_SET);
-		fread(&fileinfo, sizeof(filelump_t), 1, _g->fileWAD);
-
-		if (nameint == *(int64_t*)fileinfo.name)
-		{
-			return &fileinfo;
-		}
-	}
+	if (i == -1)
+		I_Error("W_GetFileInfoForName: %.8s not found", name);
 
-	I_Error("W_GetFileInfoForName: %.8s not found", name);
-	return NULL;
+	return &fileinfo[i];
 }
 
 
@@ -199,6 +300,148 @@ const void* PUREFUNC W_GetLumpByNum(int16_t num)
 }
 
 
+//
+// W_CacheLumpByNum
+// Returns a cached copy of the lump, reading it only when the zone
+// has thrown it out. Don't free it, and don't hold on to it across
+// other zone allocations, they can throw it out.
+//
+
+const void* W_CacheLumpByNum(int16_t num)
+{
+	const void* ptr = lumpcache[num];
+
+	if (ptr)
+	{
+		Z_TouchCache(ptr);
+		return ptr;
+	}
+
+	const filelump_t* lump = W_FindLumpByNum(num);
+	void* data = Z_MallocCache(lump->size, &lumpcache[num]);
+	fseek(_g->fileWAD, lump->filepos, SEEK_SET);
+	fread(data, lump->size, 1, _g->fileWAD);
+	return data;
+}
+
+
+//
+// W_GetPatchHeader
+// Returns the patch header and column offsets,
+// without the posts when the patch isn't cached.
+// Same lifetime rules as W_CacheLumpByNum.
+//
+
+const void* W_GetPatchHeader(int16_t num)
+{
+	const void* ptr = lumpcache[num];
+
+	if (!ptr)
+		ptr = patchheadercache[num];
+
+	if (ptr)
+	{
+		Z_TouchCache(ptr);
+		return ptr;
+	}
+
+	const filelump_t* lump = W_FindLumpByNum(num);
+
+	patch_t header;
+	fseek(_g->fileWAD, lump->filepos, SEEK_SET);
+	fread(&header, offsetof(patch_t, columnofs), 1, _g->fileWAD);
+
+	patch_t* patch = Z_MallocCache(offsetof(patch_t, columnofs) + header.width * sizeof(int32_t), &patchheadercache[num]);
+	memcpy(patch, &header, offsetof(patch_t, columnofs));
+	fread(patch->columnofs, sizeof(int32_t), header.width, _g->fileWAD);
+	return patch;
+}
+
+
+#if defined STREAM_PATCH_COLUMNS
+//
+// W_ReadPatchColumn
+// Reads the posts of a column from the current file position,
+// one post at a time, so no more than the column itself is read.
+// Returns the size of the column, or 0 if it doesn't fit in the buffer.
+//
+
+static int16_t W_ReadPatchColumn(byte* buffer)
+{
+	int16_t size = 0;
+
+	while (true)
+	{
+		// topdelta, 0xff ends the column
+		if (size + 1 > COLUMN_BUFFER_SIZE || fread(&buffer[size], 1, 1, _g->fileWAD) != 1)
+			return 0;
+
+		if (buffer[size] == 0xff)
+			return size + 1;
+
+		// length, then a pad byte, the texels and another pad byte
+		if (size + 2 > COLUMN_BUFFER_SIZE || fread(&buffer[size + 1], 1, 1, _g->fileWAD) != 1)
+			return 0;
+
+		int16_t postsize = buffer[size + 1] + 4;
+
+		if (size + postsize > COLUMN_BUFFER_SIZE || fread(&buffer[size + 2], postsize - 2, 1, _g->fileWAD) != 1)
+			return 0;
+
+		size += postsize;
+	}
+}
+#endif
+
+
+//
+// W_GetPatchColumn
+// Returns the posts of one column of a patch.
+// Valid until the next call or zone allocation.
+//
+
+const void* W_GetPatchColumn(int16_t num, int16_t col)
+{
+#if defined STREAM_PATCH_COLUMNS
+	if (!lumpcache[num])
+	{
+		uint32_t key = ((uint32_t)num << 16) | (uint16_t)col;
+		uint16_t slot = ((uint16_t)num * 37u + (uint16_t)col) & (STREAMED_COLUMNS - 1);
+
+		const void* ptr = streamedcolumns[slot];
+
+		if (ptr && streamedkeys[slot] == key)
+		{
+			Z_TouchCache(ptr);
+			return ptr;
+		}
+
+		static byte columnbuffer[COLUMN_BUFFER_SIZE];
+
+		const patch_t* patch = W_GetPatchHeader(num);
+		const filelump_t* lump = W_FindLumpByNum(num);
+
+		fseek(_g->fileWAD, lump->filepos + patch->columnofs[col], SEEK_SET);
+		int16_t size = W_ReadPatchColumn(columnbuffer);
+
+		if (size)
+		{
+			// W_GetPatchHeader may have thrown the old column out already
+			Z_Free(streamedcolumns[slot]);
+
+			byte* column = Z_MallocCache(size, &streamedcolumns[slot]);
+			memcpy(column, columnbuffer, size);
+			streamedkeys[slot] = key;
+			return column;
+		}
+	}
+#endif
+
+	const patch_t* patch = W_CacheLumpByNum(num);
+	return (const byte*)patch + patch->columnofs[col];
+}
+
+
 const void* PUREFUNC W_GetLumpByNumAutoFree(int16_t num)
 {
 	const filelump_t* lump = W_FindLumpByNum(num);
@@ -42,11 +42,15 @@
 
 void W_Init(void);
 
+int16_t     PUREFUNC W_CheckNumForName(const char *name);
 int16_t     PUREFUNC W_GetNumForName( const char *name);
 const char* PUREFUNC W_GetNameForNum(       int16_t num);
 int32_t     PUREFUNC W_LumpLength(          int16_t num);
 const void* PUREFUNC W_GetLumpByNum(        int16_t num);
 const void* PUREFUNC W_GetLumpByNumAutoFree(int16_t num);
+const void*          W_CacheLumpByNum(      int16_t num);
+const void*          W_GetPatchHeader(      int16_t num);
+const void*          W_GetPatchColumn(      int16_t num, int16_t col);
 const void* PUREFUNC W_GetLumpByName( const char *name);
 void                 W_ReadLumpByName(const char *name, void *ptr);
 
@@ -155,10 +155,8 @@ static const char total[] = {"WIMSTT"};
  */
 int16_t V_NumPatchWidth(int16_t num)
 {
-	const patch_t* patch = W_GetLumpByNum(num);
-	int16_t width = patch->width;
-	Z_Free(patch);
-	return width;
+	const patch_t* patch = W_GetPatchHeader(num);
+	return patch->width;
 }
 
 static int16_t V_NamePatchWidth(const char *name)
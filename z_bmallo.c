@@ -44,79 +44,113 @@
 #include "z_bmallo.h"
 #include "i_system.h"
 
+// Every slot starts with a pointer to its pool, so a freed element
+// finds its pool without walking the pool chain.
+// Free slots are threaded through the element memory.
+// Only pools with free slots are on the chain, full pools are
+// linked in again when one of their elements is freed.
 typedef struct bmalpool_s {
   struct bmalpool_s *nextpool;
-  size_t             blocks;
-#if defined __WATCOMC__
-  byte               used[];
-#else
-  byte               used[0];
-#endif
+  struct bmalpool_s *prevpool;
+  void              *freelist;  // first free element, NULL if the pool is full
+  size_t             used;      // elements in use
 } bmalpool_t;
 
-__inline static void* getelem(bmalpool_t *p, size_t size, size_t n)
+typedef struct {
+  bmalpool_t *pool;
+} bmalslot_t;
+
+__inline static size_t slotsize(const struct block_memory_alloc_s *pzone)
 {
-  return (((byte*)p) + sizeof(bmalpool_t) + sizeof(byte)*(p->blocks) + size*n);
+  size_t size = sizeof(bmalslot_t) + pzone->size;
+  return (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
 }
 
-__inline static PUREFUNC int32_t iselem(const bmalpool_t *pool, size_t size, const void* p)
+__inline static bmalslot_t* getslot(void* p)
 {
-  // CPhipps - need portable # of bytes between pointers
-  int32_t dif = (const char*)p - (const char*)pool;
-
-  dif -= sizeof(bmalpool_t);
-  dif -= pool->blocks;
-  if (dif<0) return -1;
-  dif /= size;
-  return (((size_t)dif >= pool->blocks) ? -1 : dif);
+  return (bmalslot_t*)((byte*)p - sizeof(bmalslot_t));
 }
 
-enum { unused_block = 0, used_block = 1};
+static void linkpool(struct block_memory_alloc_s *pzone, bmalpool_t *pool)
+{
+  pool->prevpool = NULL;
+  pool->nextpool = pzone->firstpool;
+  if (pool->nextpool)
+    pool->nextpool->prevpool = pool;
+  pzone->firstpool = pool;
+}
 
-void* Z_BMalloc(struct block_memory_alloc_s *pzone)
+static void unlinkpool(struct block_memory_alloc_s *pzone, bmalpool_t *pool)
+{
+  if (pool->prevpool)
+    pool->prevpool->nextpool = pool->nextpool;
+  else
+    pzone->firstpool = pool->nextpool;
+
+  if (pool->nextpool)
+    pool->nextpool->prevpool = pool->prevpool;
+}
+
+static bmalpool_t* newpool(struct block_memory_alloc_s *pzone)
 {
-  register bmalpool_t **pool = (bmalpool_t **)&(pzone->firstpool);
-  while (*pool != NULL) {
-    byte *p = memchr((*pool)->used, unused_block, (*pool)->blocks); // Scan for unused marker
-    if (p) {
-      int32_t n = p - (*pool)->used;
-      (*pool)->used[n] = used_block;
-      return getelem(*pool, pzone->size, n);
-    } else
-      pool = &((*pool)->nextpool);
+  size_t ssize = slotsize(pzone);
+
+  if (pzone->size < sizeof(void*))
+    I_Error("Z_BMalloc: elements of zone %s are too small", pzone->desc);
+
+  bmalpool_t *pool = Z_MallocLevel(sizeof(bmalpool_t) + ssize * pzone->perpool, NULL);
+  pool->used = 0;
+
+  // thread all slots on the free list
+  byte *slot = (byte*)pool + sizeof(bmalpool_t);
+  pool->freelist = NULL;
+  for (size_t n = 0; n < pzone->perpool; n++, slot += ssize) {
+    void *elem = slot + sizeof(bmalslot_t);
+    ((bmalslot_t*)slot)->pool = pool;
+    *(void**)elem = pool->freelist;
+    pool->freelist = elem;
   }
-  {
+
+  linkpool(pzone, pool);
+  return pool;
+}
+
+void* Z_BMalloc(struct block_memory_alloc_s *pzone)
+{
+  bmalpool_t *pool = pzone->firstpool;
+
+  if (pool == NULL)
     // Nothing available, must allocate a new pool
-    bmalpool_t *newpool;
+    pool = newpool(pzone);
 
-    // CPhipps: Allocate new memory, initialised to 0
+  void *elem = pool->freelist;
+  pool->freelist = *(void**)elem;
+  pool->used++;
 
-    *pool = newpool = Z_CallocLevel(sizeof(*newpool) + (sizeof(byte) + pzone->size) * (pzone->perpool));
-    newpool->nextpool = NULL; // NULL = (void*)0 so this is redundant
+  if (pool->freelist == NULL)
+    // Pool is full, take it off the chain
+    unlinkpool(pzone, pool);
 
-    // Return element 0 from this pool to satisfy the request
-    newpool->used[0] = used_block;
-    newpool->blocks = pzone->perpool;
-    return getelem(newpool, pzone->size, 0);
-  }
+  return elem;
 }
 
 void Z_BFree(struct block_memory_alloc_s *pzone, void* p)
 {
-  register bmalpool_t **pool = (bmalpool_t**)&(pzone->firstpool);
-
-  while (*pool != NULL) {
-    int32_t n = iselem(*pool, pzone->size, p);
-    if (n >= 0) {
-      (*pool)->used[n] = unused_block;
-      if (memchr(((*pool)->used), used_block, (*pool)->blocks) == NULL) {
-  // Block is all unused, can be freed
-  bmalpool_t *oldpool = *pool;
-  *pool = (*pool)->nextpool;
-  Z_Free(oldpool);
-      }
-      return;
-    } else pool = &((*pool)->nextpool);
+  bmalpool_t *pool = getslot(p)->pool;
+
+  if (pool->used == 0)
+    I_Error("Z_BFree: Free not in zone %s", pzone->desc);
+
+  if (pool->freelist == NULL)
+    // Pool was full, put it back on the chain
+    linkpool(pzone, pool);
+
+  *(void**)p = pool->freelist;
+  pool->freelist = p;
+
+  if (--pool->used == 0) {
+    // Block is all unused, can be freed
+    unlinkpool(pzone, pool);
+    Z_Free(pool);
   }
-  I_Error("Z_BFree: Free not in zone %s", pzone->desc);
 }
@@ -48,15 +48,24 @@
 //
 // There is never any space between memblocks,
 //  and there will never be two contiguous free memblocks.
+// Free blocks are found through segregated free lists,
+//  the rover is only used to throw out purgable blocks
+//  when none of the free blocks is big enough.
 // The rover can be left pointing at a non-empty block.
 //
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
 //
 
-#if defined INSTRUMENTED
-    static int32_t running_count = 0;
-#endif
+// statistics, see Z_GetStats
+static uint32_t heapsize;
+static uint32_t tagbytes[ZONE_NUMTAGS];
+static uint32_t tagblocks[ZONE_NUMTAGS];
+static uint32_t tagallocs[ZONE_NUMTAGS];
+static uint32_t peakused;
+static uint32_t minlargestfree;
+static uint8_t  maxfragmentation;
+static uint32_t purges;
 
 
 #define	ZONEID	0x1dea
@@ -65,6 +74,7 @@ typedef struct
 {
     uint32_t size:24;	// including the header and possibly tiny fragments
     uint32_t tag:4;		// purgelevel
+    uint32_t referenced:1;	// PU_CACHE block used since the allocator last passed it
     void**   user;		// NULL if a free block
     segment  next;
     segment  prev;
@@ -75,18 +85,46 @@ typedef struct
 
 #define PARAGRAPH_SIZE 16
 
-typedef char assertMemblockSize[sizeof(memblock_t) <= PARAGRAPH_SIZE ? 1 : -1];
+#if defined __linux__
+#define HEADER_SIZE (2 * PARAGRAPH_SIZE)	// 64-bit user pointer
+#else
+#define HEADER_SIZE PARAGRAPH_SIZE
+#endif
+
+#define HEADER_PARAGRAPHS (HEADER_SIZE / PARAGRAPH_SIZE)
+
+typedef char assertMemblockSize[sizeof(memblock_t) <= HEADER_SIZE ? 1 : -1];
+
+typedef char assertNumTags[PU_CACHE + 1 == ZONE_NUMTAGS ? 1 : -1];
 
 
 static uint8_t    *mainzone;
-static uint8_t     mainzone_blocklist_buffer[32];
+static uint8_t     mainzone_blocklist_buffer[PARAGRAPH_SIZE + HEADER_SIZE];
 static memblock_t *mainzone_blocklist;
 static segment     mainzone_rover;
 
 
+// Free blocks are also kept in segregated free lists,
+// list i holds the free blocks of 2^i up to 2^(i+1)-1 paragraphs.
+// The links live in the first paragraph after the header,
+// so every block has at least one paragraph of payload.
+typedef struct
+{
+    segment next;	// 0 terminates the list
+    segment prev;
+} freelink_t;
+
+typedef char assertFreelinkSize[sizeof(freelink_t) <= PARAGRAPH_SIZE ? 1 : -1];
+
+#define NUMFREELISTS 24
+
+static segment  freelists[NUMFREELISTS];
+static uint32_t freelistmask;	// bit i is set when list i isn't empty
+
+
 static segment pointerToSegment(const memblock_t* ptr)
 {
-	if ((((uint32_t) ptr) & (PARAGRAPH_SIZE - 1)) != 0)
+	if ((((uintptr_t) ptr) & (PARAGRAPH_SIZE - 1)) != 0)
 		I_Error("pointerToSegment: pointer is not aligned: 0x%lx", ptr);
 
 	uint32_t seg = FP_SEG(ptr);
@@ -101,6 +139,84 @@ static memblock_t* segmentToPointer(segment seg)
 }
 
 
+static freelink_t* segmentToFreeLink(segment seg)
+{
+	return MK_FP(seg + HEADER_PARAGRAPHS, 0);
+}
+
+
+static uint_fast8_t Z_FreeListNum(uint32_t size)
+{
+	uint32_t paragraphs = size / PARAGRAPH_SIZE;
+	uint_fast8_t i = 0;
+	while (paragraphs >>= 1)
+		i++;
+
+	return i;
+}
+
+
+static void Z_InsertFreeBlock(memblock_t* block)
+{
+	segment seg = pointerToSegment(block);
+	uint_fast8_t i = Z_FreeListNum(block->size);
+	freelink_t* link = segmentToFreeLink(seg);
+
+	link->prev = 0;
+	link->next = freelists[i];
+	if (freelists[i])
+		segmentToFreeLink(freelists[i])->prev = seg;
+
+	freelists[i] = seg;
+	freelistmask |= 1UL << i;
+}
+
+
+static void Z_RemoveFreeBlock(const memblock_t* block)
+{
+	uint_fast8_t i = Z_FreeListNum(block->size);
+	const freelink_t* link = segmentToFreeLink(pointerToSegment(block));
+
+	if (link->prev)
+		segmentToFreeLink(link->prev)->next = link->next;
+	else
+	{
+		freelists[i] = link->next;
+		if (!link->next)
+			freelistmask &= ~(1UL << i);
+	}
+
+	if (link->next)
+		segmentToFreeLink(link->next)->prev = link->prev;
+}
+
+
+//
+// Z_FindFreeBlock
+// Every block in a list above the requested size's own list fits,
+// so the first one of those is taken.
+// Only when those are all empty, the requested size's list is searched.
+// Returns NULL when no free block is big enough.
+//
+static memblock_t* Z_FindFreeBlock(uint32_t size)
+{
+	uint_fast8_t i = Z_FreeListNum(size);
+
+	for (uint_fast8_t j = i + 1; j < NUMFREELISTS; j++)
+		if (freelistmask & (1UL << j))
+			return segmentToPointer(freelists[j]);
+
+	for (segment seg = freelists[i]; seg; seg = segmentToFreeLink(seg)->next)
+	{
+		memblock_t* block = segmentToPointer(seg);
+		if (block->size >= size)
+			return block;
+	}
+
+	return NULL;
+}
+
+
 //
 // Z_Init
 //
@@ -123,21 +239,21 @@ void Z_Init (void)
     heapSize = hallocNumb * PARAGRAPH_SIZE;
 
     //align mainzone
-    uint32_t m = (uint32_t) mainzone;
+    uintptr_t m = (uintptr_t) mainzone;
     if ((m & (PARAGRAPH_SIZE - 1)) != 0)
     {
         heapSize -= PARAGRAPH_SIZE;
         while ((m & (PARAGRAPH_SIZE - 1)) != 0)
-            m = (uint32_t) ++mainzone;
+            m = (uintptr_t) ++mainzone;
     }
 
     printf("\t%ld bytes allocated for zone\n", heapSize);
 
     //align blocklist
     uint_fast8_t i = 0;
-    uint32_t b = (uint32_t) &mainzone_blocklist_buffer[i++];
+    uintptr_t b = (uintptr_t) &mainzone_blocklist_buffer[i++];
     while ((b & (PARAGRAPH_SIZE - 1)) != 0)
-        b = (uint32_t) &mainzone_blocklist_buffer[i++];
+        b = (uintptr_t) &mainzone_blocklist_buffer[i++];
     mainzone_blocklist = (memblock_t *)b;
 
     // set the entire zone to one free block
@@ -156,6 +272,11 @@ void Z_Init (void)
     block->user = NULL;
 
     block->size = heapSize;
+
+    Z_InsertFreeBlock(block);
+
+    heapsize = heapSize;
+    Z_ResetStats();
 }
 
 
@@ -170,7 +291,7 @@ void Z_Free (const void* ptr)
     if (ptr == NULL)
         return;
 
-    block = segmentToPointer(pointerToSegment(ptr) - 1);
+    block = segmentToPointer(pointerToSegment(ptr) - HEADER_PARAGRAPHS);
 
 #if defined _M_I86
     if (block->id != ZONEID)
@@ -186,21 +307,19 @@ void Z_Free (const void* ptr)
         *block->user = 0;
     }
 
+    tagbytes[block->tag] -= block->size;
+    tagblocks[block->tag]--;
+
     // mark as free
     block->user = NULL;
     block->tag  = 0;
 
-
-#if defined INSTRUMENTED
-    running_count -= block->size;
-    printf("Free: %ld\n", running_count);
-#endif
-
     other = segmentToPointer(block->prev);
 
     if (!other->user)
     {
         // merge with previous free block
+        Z_RemoveFreeBlock(other);
         other->size += block->size;
         other->next = block->next;
         segmentToPointer(other->next)->prev = pointerToSegment(other);
@@ -215,6 +334,7 @@ void Z_Free (const void* ptr)
     if (!other->user)
     {
         // merge the next free block onto the end
+        Z_RemoveFreeBlock(other);
         block->size += other->size;
         block->next = other->next;
         segmentToPointer(block->next)->prev = pointerToSegment(block);
@@ -222,10 +342,12 @@ void Z_Free (const void* ptr)
         if (pointerToSegment(other) == mainzone_rover)
             mainzone_rover = pointerToSegment(block);
     }
+
+    Z_InsertFreeBlock(block);
 }
 
 
-static uint32_t Z_GetLargestFreeBlockSize(void)
+uint32_t Z_GetLargestFreeBlockSize(void)
 {
 	uint32_t largestFreeBlockSize = 0;
 
@@ -249,24 +371,142 @@ static uint32_t Z_GetTotalFreeMemory(void)
 
 
 //
-// Z_Malloc
-// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+// Z_LargestFreeInLists
+// Only the highest non-empty free list can hold the largest free block.
 //
-#define MINFRAGMENT		64
+static uint32_t Z_LargestFreeInLists(void)
+{
+	uint32_t largest = 0;
 
+	for (int_fast8_t i = NUMFREELISTS - 1; i >= 0; i--)
+	{
+		if (freelistmask & (1UL << i))
+		{
+			for (segment seg = freelists[i]; seg; seg = segmentToFreeLink(seg)->next)
+				if (segmentToPointer(seg)->size > largest)
+					largest = segmentToPointer(seg)->size;
 
-static void* Z_Malloc(int32_t size, int32_t tag, void **user)
+			break;
+		}
+	}
+
+	return largest;
+}
+
+
+static uint32_t Z_FreeBytes(void)
 {
-    size = (size + (PARAGRAPH_SIZE - 1)) & ~(PARAGRAPH_SIZE - 1);
+	uint32_t used = 0;
+	for (uint_fast8_t tag = PU_STATIC; tag < ZONE_NUMTAGS; tag++)
+		used += tagbytes[tag];
 
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
+	return heapsize - used;
+}
+
+
+static uint8_t Z_Fragmentation(uint32_t freebytes, uint32_t largestfree)
+{
+	return freebytes ? 100 - (largestfree * 100 / freebytes) : 0;
+}
+
+
+static void Z_UpdateWatermarks(void)
+{
+	uint32_t used = tagbytes[PU_STATIC] + tagbytes[PU_LEVEL] + tagbytes[PU_LEVSPEC];
+	if (used > peakused)
+		peakused = used;
+
+	uint32_t largestfree = Z_LargestFreeInLists();
+	if (largestfree < minlargestfree)
+		minlargestfree = largestfree;
+
+	uint8_t fragmentation = Z_Fragmentation(Z_FreeBytes(), largestfree);
+	if (fragmentation > maxfragmentation)
+		maxfragmentation = fragmentation;
+}
+
+
+//
+// Z_ResetStats
+// Starts a new period for the allocation counts and the watermarks.
+//
+void Z_ResetStats(void)
+{
+	for (uint_fast8_t tag = 0; tag < ZONE_NUMTAGS; tag++)
+		tagallocs[tag] = 0;
+
+	peakused         = 0;
+	minlargestfree   = heapsize;
+	maxfragmentation = 0;
+	purges           = 0;
+
+	Z_UpdateWatermarks();
+}
+
+
+//
+// Z_GetStats
+//
+void Z_GetStats(zonestats_t* stats)
+{
+	for (uint_fast8_t tag = 0; tag < ZONE_NUMTAGS; tag++)
+	{
+		stats->tagbytes[tag]  = tagbytes[tag];
+		stats->tagblocks[tag] = tagblocks[tag];
+		stats->tagallocs[tag] = tagallocs[tag];
+	}
+
+	stats->heapsize         = heapsize;
+	stats->freebytes        = Z_FreeBytes();
+	stats->largestfree      = Z_LargestFreeInLists();
+	stats->fragmentation    = Z_Fragmentation(stats->freebytes, stats->largestfree);
+	stats->peakused         = peakused;
+	stats->minlargestfree   = minlargestfree;
+	stats->maxfragmentation = maxfragmentation;
+	stats->purges           = purges;
+}
+
+
+//
+// Z_DumpStats
+//
+void Z_DumpStats(FILE* fp, const char* title)
+{
+	static const char* const tagnames[ZONE_NUMTAGS] = {"", "static", "level", "levspec", "cache"};
+
+	zonestats_t stats;
+	Z_GetStats(&stats);
+
+	fprintf(fp, "Zone memory: %s\n", title);
+	fprintf(fp, "  tag      blocks    bytes   allocs\n");
+	for (uint_fast8_t tag = PU_STATIC; tag < ZONE_NUMTAGS; tag++)
+		fprintf(fp, "  %-7s %7lu %8lu %8lu\n", tagnames[tag], (unsigned long)stats.tagblocks[tag], (unsigned long)stats.tagbytes[tag], (unsigned long)stats.tagallocs[tag]);
+
+	fprintf(fp, "  free %lu of %lu bytes, largest free block %lu bytes, fragmentation %u%%\n",
+		(unsigned long)stats.freebytes, (unsigned long)stats.heapsize, (unsigned long)stats.largestfree, stats.fragmentation);
+	fprintf(fp, "  peak %lu bytes not purgable, smallest largest free block %lu bytes, worst fragmentation %u%%, %lu blocks purged\n",
+		(unsigned long)stats.peakused, (unsigned long)stats.minlargestfree, stats.maxfragmentation, (unsigned long)stats.purges);
+	fflush(fp);
+}
+
+
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+//
+#define MINFRAGMENT		64
 
-    // account for size of block header
-    size += PARAGRAPH_SIZE;
 
+//
+// Z_PurgeBlocks
+// When no free block is big enough,
+// scan through the block list,
+// looking for the first run of free and purgable blocks
+// of sufficient size,
+// throwing out the purgable blocks along the way.
+//
+static memblock_t* Z_PurgeBlocks(int32_t size)
+{
     // if there is a free block behind the rover,
     //  back up over them
     memblock_t* base = segmentToPointer(mainzone_rover);
@@ -275,14 +515,21 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
         base = segmentToPointer(base->prev);
 
     memblock_t* rover = base;
-    memblock_t* start = segmentToPointer(base->prev);
+
+    // Purgable blocks that have been referenced get a second chance,
+    // so the least recently used lumps are thrown out first.
+    // The laps are counted at the head of the block list, which is
+    // never freed. By the first pass the scan has cleared the reference
+    // bits of the blocks before the head, by the second those of all
+    // blocks, and by the third every purgable block has been thrown out.
+    int16_t laps = 0;
 
     do
     {
-        if (rover == start)
+        if (pointerToSegment(rover) == pointerToSegment(mainzone_blocklist))
         {
-            // scanned all the way around the list
-            I_Error ("Z_Malloc: failed to allocate %li B, max free block %li B, total free %li", size, Z_GetLargestFreeBlockSize(), Z_GetTotalFreeMemory());
+            if (++laps == 3)
+                I_Error ("Z_Malloc: failed to allocate %li B, max free block %li B, total free %li", size, Z_GetLargestFreeBlockSize(), Z_GetTotalFreeMemory());
         }
 
         if (rover->user)
@@ -293,13 +540,20 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
                 //  so move base past it
                 base = rover = segmentToPointer(rover->next);
             }
+            else if (rover->referenced)
+            {
+                // recently used, skip it this time
+                rover->referenced = false;
+                base = rover = segmentToPointer(rover->next);
+            }
             else
             {
                 // free the rover block (adding the size to base)
 
                 // the rover can be the base block
+                purges++;
                 base  = segmentToPointer(base->prev);
-                Z_Free(segmentToPointer(pointerToSegment(rover) + 1));
+                Z_Free(segmentToPointer(pointerToSegment(rover) + HEADER_PARAGRAPHS));
                 base  = segmentToPointer(base->next);
                 rover = segmentToPointer(base->next);
             }
@@ -309,8 +563,29 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
 
     } while (base->user || base->size < size);
 
+    return base;
+}
+
+
+static void* Z_Malloc(int32_t size, int32_t tag, void **user)
+{
+    size = (size + (PARAGRAPH_SIZE - 1)) & ~(PARAGRAPH_SIZE - 1);
+
+    // room for the free list links when the block is freed
+    if (size == 0)
+        size = PARAGRAPH_SIZE;
+
+    // account for size of block header
+    size += HEADER_SIZE;
+
+    memblock_t* base = Z_FindFreeBlock(size);
+
+    if (!base)
+        base = Z_PurgeBlocks(size);
 
     // found a block big enough
+    Z_RemoveFreeBlock(base);
+
     int32_t extra = base->size - size;
 
     if (extra > MINFRAGMENT)
@@ -322,19 +597,22 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
         // NULL indicates free block.
         newblock->user = NULL;
         newblock->tag  = 0;
+        newblock->referenced = false;
         newblock->prev = pointerToSegment(base);
         newblock->next = base->next;
         segmentToPointer(newblock->next)->prev = pointerToSegment(newblock);
 
         base->next = pointerToSegment(newblock);
         base->size = size;
+
+        Z_InsertFreeBlock(newblock);
     }
 
     if (user)
     {
         // mark as an in use block
         base->user = user;
-        *(void **)user = segmentToPointer(pointerToSegment(base) + 1);
+        *(void **)user = segmentToPointer(pointerToSegment(base) + HEADER_PARAGRAPHS);
     }
     else
     {
@@ -346,6 +624,7 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
     }
 
     base->tag = tag;
+    base->referenced = false;
 #if defined _M_I86
     base->id  = ZONEID;
 #endif
@@ -353,12 +632,12 @@ static void* Z_Malloc(int32_t size, int32_t tag, void **user)
     // next allocation will start looking here
     mainzone_rover = base->next;
 
-#if defined INSTRUMENTED
-    running_count += base->size;
-    printf("Alloc: %ld (%ld)\n", base->size, running_count);
-#endif
+    tagbytes[tag] += base->size;
+    tagblocks[tag]++;
+    tagallocs[tag]++;
+    Z_UpdateWatermarks();
 
-    return segmentToPointer(pointerToSegment(base) + 1);
+    return segmentToPointer(pointerToSegment(base) + HEADER_PARAGRAPHS);
 }
 
 
@@ -374,6 +653,28 @@ void* Z_MallocLevel(int32_t size, void **user)
 }
 
 
+//
+// Z_MallocCache
+// The block can be thrown out by any later allocation,
+// *user is set to NULL when that happens.
+//
+void* Z_MallocCache(int32_t size, void **user)
+{
+	return Z_Malloc(size, PU_CACHE, user);
+}
+
+
+//
+// Z_TouchCache
+// Marks a PU_CACHE block as recently used.
+//
+void Z_TouchCache(const void* ptr)
+{
+	memblock_t* block = segmentToPointer(pointerToSegment(ptr) - HEADER_PARAGRAPHS);
+	block->referenced = true;
+}
+
+
 void* Z_CallocLevSpec(int32_t size)
 {
 	void *ptr = Z_Malloc(size, PU_LEVSPEC, NULL);
@@ -407,7 +708,7 @@ void Z_FreeTags(void)
             continue;
 
         if (PU_LEVEL <= block->tag && block->tag <= (PU_PURGELEVEL - 1))
-            Z_Free(segmentToPointer(pointerToSegment(block) + 1));
+            Z_Free(segmentToPointer(pointerToSegment(block) + HEADER_PARAGRAPHS));
     }
 }
 
@@ -438,4 +739,31 @@ void Z_CheckHeap (void)
         if (!block->user && !segmentToPointer(block->next)->user)
             I_Error ("Z_CheckHeap: two consecutive free blocks\n");
     }
+
+    uint32_t freeblocks = 0;
+    for (memblock_t* block = segmentToPointer(mainzone_blocklist->next); pointerToSegment(block) != pointerToSegment(mainzone_blocklist); block = segmentToPointer(block->next))
+        if (!block->user)
+            freeblocks++;
+
+    for (uint_fast8_t i = 0; i < NUMFREELISTS; i++)
+    {
+        if (!freelists[i] != !(freelistmask & (1UL << i)))
+            I_Error ("Z_CheckHeap: free list %i doesn't match the mask\n", i);
+
+        for (segment seg = freelists[i]; seg; seg = segmentToFreeLink(seg)->next)
+        {
+            const memblock_t* block = segmentToPointer(seg);
+
+            if (block->user)
+                I_Error ("Z_CheckHeap: used block in free list %i\n", i);
+
+            if (Z_FreeListNum(block->size) != i)
+                I_Error ("Z_CheckHeap: block in the wrong free list %i\n", i);
+
+            freeblocks--;
+        }
+    }
+
+    if (freeblocks != 0)
+        I_Error ("Z_CheckHeap: free lists don't hold all free blocks\n");
 }
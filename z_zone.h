@@ -27,15 +27,41 @@
 #define __Z_ZONE__
 
 #include <stddef.h>
+#include <stdio.h>
 
 void	Z_Init(void);
 void*	Z_MallocStatic(int32_t size);
 void*	Z_MallocLevel(int32_t size, void **ptr);
+void*	Z_MallocCache(int32_t size, void **user);
+void	Z_TouchCache(const void *ptr);
 void*	Z_CallocLevel(int32_t size);
 void*	Z_CallocLevSpec(int32_t size);
 void	Z_Free(const void *ptr);
 void	Z_FreeTags(void);
 void	Z_CheckHeap(void);
 void	Z_CheckHeap(void);
+uint32_t	Z_GetLargestFreeBlockSize(void);
+
+
+#define ZONE_NUMTAGS 5	// free, static, level, levspec and cache
+
+typedef struct
+{
+	uint32_t tagbytes[ZONE_NUMTAGS];	// bytes per purge tag, headers included
+	uint32_t tagblocks[ZONE_NUMTAGS];	// blocks per purge tag
+	uint32_t tagallocs[ZONE_NUMTAGS];	// allocations per purge tag since Z_ResetStats
+	uint32_t heapsize;
+	uint32_t freebytes;
+	uint32_t largestfree;
+	uint8_t  fragmentation;				// percentage of free memory outside the largest free block
+	uint32_t peakused;					// most static, level and levspec bytes since Z_ResetStats
+	uint32_t minlargestfree;			// smallest largest free block since Z_ResetStats
+	uint8_t  maxfragmentation;			// worst fragmentation since Z_ResetStats
+	uint32_t purges;					// purged cache blocks since Z_ResetStats
+} zonestats_t;
+
+void	Z_ResetStats(void);
+void	Z_GetStats(zonestats_t* stats);
+void	Z_DumpStats(FILE* fp, const char* title);
 
 #endif